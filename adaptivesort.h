@@ -0,0 +1,370 @@
+/**
+ * Adaptive Merge Sorts that take advantage of runs already in the data, so
+ * that presorted and nearly sorted lists are sorted in close to linear
+ * time. The list is scanned from left to right for maximal runs, which are
+ * either nondecreasing or strictly decreasing, the latter reversed in place;
+ * runs shorter than a minimum length of 32 to 64 elements are extended with
+ * a binary Insertion Sort. Runs are kept on a stack and merged according to
+ * one of two policies: TimSort's, which keeps the lengths on the stack
+ * growing faster than the Fibonacci numbers, or Powersort's, which merges
+ * runs in the order of a nearly optimal binary merge tree computed from
+ * their positions in the list.
+ *
+ * Before two runs are merged, binary searches leave out the prefix of the
+ * left run and the suffix of the right run that are already in place, and
+ * only the rest of the left run is moved to a buffer. While merging, once
+ * one run wins several times in a row, the merge switches to galloping,
+ * finding with an exponential search how many more elements it wins at
+ * once, and the number of wins needed to switch adapts to how often
+ * galloping pays off.
+ */
+
+#ifndef ADAPTIVESORT_H
+#define ADAPTIVESORT_H
+
+/* include statements */
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "scratcharena.h"
+
+/* The policies deciding which runs an adaptive Merge Sort merges when */
+enum MergePolicy {
+    POLICY_TIMSORT,
+    POLICY_POWERSORT
+};
+
+/* A sorted run awaiting merging */
+struct AdaptiveRun {
+    int start;   /* Index of the run's first element */
+    int length;  /* Number of elements in the run */
+    int power;   /* Powersort depth of the boundary before the run */
+};
+
+/* constants */
+const int MIN_GALLOP = 7;          /* Consecutive wins that start galloping */
+const int MIN_MERGE_LENGTH = 64;   /* Lists shorter than this are one binary insertion run */
+
+/* function declarations */
+template <typename T, typename Compare>
+void adaptive_merge_sort (T *v, int n, MergePolicy policy, Compare comp);
+
+template <typename T, typename Compare>
+int count_run (T *v, int start, int n, Compare comp);
+template <typename T, typename Compare>
+void binary_insertion_sort (T *v, int start, int sorted, int end, Compare comp);
+template <typename T, typename Compare>
+void merge_runs (T *v, int start, int middle, int end, ScratchVector<T>& buffer,
+    int& min_gallop, Compare comp);
+template <typename T, typename Compare>
+int gallop_right (const T& key, const T *v, int n, Compare comp);
+template <typename T, typename Compare>
+int gallop_left (const T& key, const T *v, int n, Compare comp);
+template <typename T, typename Compare>
+void merge_at (T *v, ScratchVector<AdaptiveRun>& runs, int i, ScratchVector<T>& buffer,
+    int& min_gallop, Compare comp);
+inline int min_run_length (int n);
+inline int node_power (int start1, int length1, int length2, int n);
+
+/*
+ * Sort the n elements of the given list in place, stably, using an adaptive
+ * Merge Sort with the given merge policy.
+ */
+template <typename T, typename Compare>
+void adaptive_merge_sort (T *v, int n, MergePolicy policy, Compare comp)
+{
+    ScratchVector<AdaptiveRun> runs;  /* Stack of runs awaiting merging */
+    ScratchVector<T> buffer;          /* Copy of the left run of a merge */
+    int min_gallop = MIN_GALLOP;      /* Consecutive wins that currently start galloping */
+    int min_run = min_run_length(n);  /* Length that short runs are extended to */
+    int start, end;                   /* Bounds of the current run */
+
+    for (start = 0; start < n; start = end) {
+        end = count_run(v, start, n, comp);
+
+        if (end - start < min_run) {
+            int extended = std::min(start + min_run, n);
+
+            binary_insertion_sort(v, start, end, extended, comp);
+            end = extended;
+        }
+
+        AdaptiveRun run = AdaptiveRun{start, end - start, 0};
+
+        if (policy == POLICY_POWERSORT) {
+            /* Merge the runs below boundaries deeper than the new one */
+            if (!runs.empty())
+                run.power = node_power(runs.back().start, runs.back().length, run.length, n);
+
+            while (runs.size() > 1 && runs.back().power > run.power)
+                merge_at(v, runs, runs.size() - 2, buffer, min_gallop, comp);
+
+            runs.push_back(run);
+            continue;
+        }
+
+        runs.push_back(run);
+
+        /* Restore TimSort's invariants on the lengths of the top runs:
+         * each exceeds the sum of the next two above it, and each exceeds
+         * the one above it */
+        while (runs.size() > 1) {
+            int i = runs.size() - 2;  /* Lower of the runs to merge */
+
+            if ((i > 0 && runs[i - 1].length <= runs[i].length + runs[i + 1].length) ||
+                (i > 1 && runs[i - 2].length <= runs[i - 1].length + runs[i].length)) {
+                if (runs[i - 1].length < runs[i + 1].length)
+                    --i;
+            } else if (runs[i].length > runs[i + 1].length) {
+                break;
+            }
+
+            merge_at(v, runs, i, buffer, min_gallop, comp);
+        }
+    }
+
+    while (runs.size() > 1) {
+        int i = runs.size() - 2;  /* Lower of the runs to merge */
+
+        if (policy == POLICY_TIMSORT && i > 0 && runs[i - 1].length < runs[i + 1].length)
+            --i;
+
+        merge_at(v, runs, i, buffer, min_gallop, comp);
+    }
+}
+
+/*
+ * Helper function for the adaptive Merge Sorts that returns the end of the
+ * run starting at index start among the first n elements of the given list.
+ * A strictly decreasing run is reversed, which keeps the sort stable.
+ */
+template <typename T, typename Compare>
+int count_run (T *v, int start, int n, Compare comp)
+{
+    int end;  /* Index one past the run */
+
+    end = start + 1;
+
+    if (end >= n)
+        return n;
+
+    if (comp(v[end], v[start])) {
+        while (++end < n && comp(v[end], v[end - 1]))
+            ;
+        std::reverse(v + start, v + end);
+    } else {
+        while (++end < n && !comp(v[end], v[end - 1]))
+            ;
+    }
+
+    return end;
+}
+
+/*
+ * Helper function for the adaptive Merge Sorts that sorts the sublist of
+ * the given list from index start up to end, of which the elements up to
+ * sorted are already sorted, inserting each of the others where a binary
+ * search places it, after any elements equal to it.
+ */
+template <typename T, typename Compare>
+void binary_insertion_sort (T *v, int start, int sorted, int end, Compare comp)
+{
+    int i;  /* Index of the element being inserted */
+
+    for (i = std::max(sorted, start + 1); i < end; ++i) {
+        T x = std::move(v[i]);
+        T *position = std::upper_bound(v + start, v + i, x, comp);
+
+        std::move_backward(position, v + i, v + i + 1);
+        *position = std::move(x);
+    }
+}
+
+/*
+ * Helper function for the adaptive Merge Sorts that merges the sorted
+ * sublists of the given list from index start to middle and from middle to
+ * end, using buffer to hold the part of the left sublist that moves, and
+ * galloping once one side wins min_gallop times in a row.
+ */
+template <typename T, typename Compare>
+void merge_runs (T *v, int start, int middle, int end, ScratchVector<T>& buffer,
+    int& min_gallop, Compare comp)
+{
+    int length;    /* Number of elements of the left sublist left to merge */
+    int a, b;      /* Next elements of the buffered left and the right sublist */
+    int out;       /* Next position to write to */
+    int wins_a;    /* Consecutive elements taken from the left sublist */
+    int wins_b;    /* Consecutive elements taken from the right sublist */
+    int gallop_a;  /* Elements of the left sublist taken by a gallop */
+    int gallop_b;  /* Elements of the right sublist taken by a gallop */
+
+    /* Elements of the left sublist not above the right's first element, and
+     * those of the right sublist not below the left's last, are in place */
+    start += gallop_right(v[middle], v + start, middle - start, comp);
+    if (start == middle)
+        return;
+
+    end = middle + gallop_left(v[middle - 1], v + middle, end - middle, comp);
+    if (end == middle)
+        return;
+
+    length = middle - start;
+    if ((int) buffer.size() < length)
+        buffer.resize(length);
+
+    std::move(v + start, v + middle, buffer.begin());
+    a = 0;
+    b = middle;
+    out = start;
+
+    while (a < length && b < end) {
+        wins_a = wins_b = 0;
+
+        /* Take one element at a time until one side keeps winning */
+        while (a < length && b < end) {
+            if (comp(v[b], buffer[a])) {
+                v[out++] = std::move(v[b++]);
+                wins_a = 0;
+                if (++wins_b >= min_gallop)
+                    break;
+            } else {
+                v[out++] = std::move(buffer[a++]);
+                wins_b = 0;
+                if (++wins_a >= min_gallop)
+                    break;
+            }
+        }
+
+        /* Then gallop for as long as galloping takes long strides */
+        while (a < length && b < end) {
+            gallop_a = gallop_right(v[b], buffer.data() + a, length - a, comp);
+            out = std::move(buffer.begin() + a, buffer.begin() + a + gallop_a, v + out) - v;
+            a += gallop_a;
+            if (a == length)
+                break;
+
+            gallop_b = gallop_left(buffer[a], v + b, end - b, comp);
+            out = std::move(v + b, v + b + gallop_b, v + out) - v;
+            b += gallop_b;
+
+            min_gallop = std::max(min_gallop - 1, 1);
+
+            if (gallop_a < MIN_GALLOP && gallop_b < MIN_GALLOP) {
+                min_gallop += 2;
+                break;
+            }
+        }
+    }
+
+    /* What remains of the right sublist is already in place */
+    std::move(buffer.begin() + a, buffer.begin() + length, v + out);
+}
+
+/*
+ * Helper function for the adaptive Merge Sorts that returns the number of
+ * the n elements of the given sorted list that are not above key, found
+ * by an exponential search from the start and then a binary search.
+ */
+template <typename T, typename Compare>
+int gallop_right (const T& key, const T *v, int n, Compare comp)
+{
+    int lo, hi;  /* The answer lies between these */
+
+    lo = 0;
+    hi = 1;
+
+    while (hi <= n && !comp(key, v[hi - 1])) {
+        lo = hi;
+        hi = 2 * hi + 1;
+    }
+
+    return std::upper_bound(v + lo, v + std::min(hi, n), key, comp) - v;
+}
+
+/*
+ * Helper function for the adaptive Merge Sorts that returns the number of
+ * the n elements of the given sorted list that are below key, found by an
+ * exponential search from the start and then a binary search.
+ */
+template <typename T, typename Compare>
+int gallop_left (const T& key, const T *v, int n, Compare comp)
+{
+    int lo, hi;  /* The answer lies between these */
+
+    lo = 0;
+    hi = 1;
+
+    while (hi <= n && comp(v[hi - 1], key)) {
+        lo = hi;
+        hi = 2 * hi + 1;
+    }
+
+    return std::lower_bound(v + lo, v + std::min(hi, n), key, comp) - v;
+}
+
+/*
+ * Helper function for the adaptive Merge Sorts that merges the runs at
+ * index i and i + 1 of the stack into one at index i.
+ */
+template <typename T, typename Compare>
+void merge_at (T *v, ScratchVector<AdaptiveRun>& runs, int i, ScratchVector<T>& buffer,
+    int& min_gallop, Compare comp)
+{
+    AdaptiveRun& left = runs[i];
+    const AdaptiveRun& right = runs[i + 1];
+
+    merge_runs(v, left.start, right.start, right.start + right.length, buffer, min_gallop,
+        comp);
+    left.length += right.length;
+    runs.erase(runs.begin() + i + 1);
+}
+
+/*
+ * Return TimSort's minimum run length for a list of n elements: n itself
+ * when it is short, and otherwise a length between 32 and 64 that splits n
+ * into a power of two runs, or slightly fewer.
+ */
+inline int min_run_length (int n)
+{
+    int extra = 0;  /* Whether any bit shifted out was set */
+
+    while (n >= MIN_MERGE_LENGTH) {
+        extra |= n & 1;
+        n >>= 1;
+    }
+
+    return n + extra;
+}
+
+/*
+ * Return the depth in Powersort's merge tree of the boundary between the
+ * run of length1 elements starting at index start1 and the run of length2
+ * elements following it, in a list of n elements: the first bit at which
+ * the binary fractions of the two runs' midpoints, relative to n, differ.
+ */
+inline int node_power (int start1, int length1, int length2, int n)
+{
+    long long a = 2LL * start1 + length1;        /* Twice the first midpoint */
+    long long b = a + length1 + length2;         /* Twice the second midpoint */
+    const long long scale = 2LL * n;             /* Twice the length of the list */
+    int power = 0;                               /* Bits compared so far */
+
+    do {
+        ++power;
+        a *= 2;
+        b *= 2;
+
+        if ((a >= scale) != (b >= scale))
+            break;
+
+        if (a >= scale) {
+            a -= scale;
+            b -= scale;
+        }
+    } while (true);
+
+    return power;
+}
+
+#endif // ADAPTIVESORT_H
@@ -0,0 +1,248 @@
+/**
+ * Auto Sort, a hybrid that sorts each list with whichever registered
+ * algorithm was fastest on similar datasets in earlier runs. A cheap probe
+ * reduces a list to its features: its length, the number of ascending runs
+ * in it, the fraction of duplicates among a sample of its elements, and
+ * the number of bits spanned by the range of its keys. The features are
+ * bucketed into a feature class, and Auto Sort looks the class up in a
+ * table filled from a calibration file, which records the fastest
+ * algorithm measured on each class, and dispatches to it. A class without
+ * measurements of its own takes the algorithm of the nearest class that
+ * has some. The probe runs inside the timed region, so Auto Sort's times
+ * include its overhead and show whether dispatching beats the best fixed
+ * choice.
+ *
+ * With --calibration FILE, the table is loaded from FILE before a run, and
+ * after the run the fastest algorithm on each dataset is recorded in it
+ * under the dataset's feature class and the element type, and it is saved
+ * back to FILE.
+ */
+
+#include "autosort.h"
+
+/* Names of the run classes in calibration files, indexed by RunClass */
+static const char *run_class_names[NUM_RUN_CLASSES] = {"sorted", "reversed", "few",
+    "many"};
+
+/* Names of the duplicate classes, indexed by DuplicateClass */
+static const char *duplicate_class_names[NUM_DUPLICATE_CLASSES] = {"low", "some", "high"};
+
+/* Widths of the keys of each key bits class */
+static const int key_bits_class_bits[NUM_KEY_BITS_CLASSES] = {8, 16, 32, 64};
+
+/*
+ * Bucket the given features into their feature class.
+ */
+void classify_features (const DatasetFeatures& features, FeatureClass& feature_class)
+{
+    int size_log2 = 0;  /* floor(log2(n)) */
+    int bits_class = 0; /* Index of the narrowest key width spanning the keys */
+
+    while (size_log2 < NUM_SIZE_CLASSES - 1 && (2LL << size_log2) <= features.n)
+        ++size_log2;
+
+    while (bits_class < NUM_KEY_BITS_CLASSES - 1 &&
+            features.key_bits > key_bits_class_bits[bits_class])
+        ++bits_class;
+
+    feature_class.size_log2 = size_log2;
+    feature_class.key_bits_class = bits_class;
+
+    if (features.runs <= 1)
+        feature_class.runs = RUNS_SORTED;
+    else if (features.runs == features.n)
+        feature_class.runs = RUNS_REVERSED;
+    else if (features.runs * FEW_RUNS_RATIO <= features.n)
+        feature_class.runs = RUNS_FEW;
+    else
+        feature_class.runs = RUNS_MANY;
+
+    if (features.duplicates >= HIGH_DUPLICATES)
+        feature_class.duplicates = DUPLICATES_HIGH;
+    else if (features.duplicates >= SOME_DUPLICATES)
+        feature_class.duplicates = DUPLICATES_SOME;
+    else
+        feature_class.duplicates = DUPLICATES_LOW;
+}
+
+/*
+ * Return the index of the given feature class, from 0 to
+ * NUM_FEATURE_CLASSES - 1.
+ */
+int feature_class_index (const FeatureClass& feature_class)
+{
+    return ((feature_class.size_log2 * NUM_RUN_CLASSES + feature_class.runs) *
+        NUM_DUPLICATE_CLASSES + feature_class.duplicates) * NUM_KEY_BITS_CLASSES +
+        feature_class.key_bits_class;
+}
+
+/*
+ * Set the given feature class to the one with the given index, undoing
+ * feature_class_index().
+ */
+void feature_class_at (int index, FeatureClass& feature_class)
+{
+    feature_class.key_bits_class = index % NUM_KEY_BITS_CLASSES;
+    index /= NUM_KEY_BITS_CLASSES;
+    feature_class.duplicates = (DuplicateClass) (index % NUM_DUPLICATE_CLASSES);
+    index /= NUM_DUPLICATE_CLASSES;
+    feature_class.runs = (RunClass) (index % NUM_RUN_CLASSES);
+    feature_class.size_log2 = index / NUM_RUN_CLASSES;
+}
+
+/*
+ * Return how unlike each other the two feature classes are. Presortedness
+ * weighs the most, since it decides between the adaptive algorithms and the
+ * rest, then duplicates and the width of the keys, and each doubling of the
+ * length the least.
+ */
+int feature_distance (const FeatureClass& a, const FeatureClass& b)
+{
+    return std::abs(a.size_log2 - b.size_log2) + 8 * (a.runs != b.runs) +
+        4 * std::abs(a.duplicates - b.duplicates) +
+        2 * std::abs(a.key_bits_class - b.key_bits_class);
+}
+
+/*
+ * Print a description of the given feature class to the given stream.
+ */
+void describe_feature_class (const FeatureClass& feature_class, std::ostream& out)
+{
+    out << "n = 2^" << feature_class.size_log2 << ", "
+        << run_class_names[feature_class.runs] << " runs, "
+        << duplicate_class_names[feature_class.duplicates] << " duplicates, "
+        << key_bits_class_bits[feature_class.key_bits_class] << "-bit keys";
+}
+
+/*
+ * Record the given entry in the calibration table, in place of any entry
+ * for the same element type and feature class.
+ */
+void update_calibration (CalibrationTable& table, const CalibrationEntry& entry)
+{
+    const int index = feature_class_index(entry.features);  /* Class of the entry */
+
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        if (table[i].element_type == entry.element_type &&
+                feature_class_index(table[i].features) == index) {
+            table[i] = entry;
+            return;
+        }
+    }
+
+    table.push_back(entry);
+}
+
+/*
+ * Load the calibration table from the file at the given path. A file that
+ * does not exist yet leaves the table empty. Return false, after notifying
+ * the user, if the file cannot be read or holds a malformed line.
+ */
+bool load_calibration (const char *path, CalibrationTable& table)
+{
+    std::ifstream file(path);  /* The calibration file being loaded */
+    std::string line;          /* Current line of the file */
+    int line_number = 0;       /* Number of the current line, from 1 */
+
+    table.clear();
+
+    if (!file) {
+        if (errno == ENOENT)
+            return true;
+
+        std::cerr << "ERROR: Failed to open calibration file " << path << ": "
+            << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);  /* Fields of the current line */
+        CalibrationEntry entry;           /* Entry the line holds */
+        std::string runs, duplicates;     /* Names of its run and duplicate classes */
+        int key_bits = 0;                 /* Width of its keys */
+        int r, d, b;                      /* Indices of the names and width */
+        std::size_t first;                /* Index of the first non-blank character */
+
+        ++line_number;
+        first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+
+        fields >> entry.element_type >> entry.features.size_log2 >> runs >> duplicates
+            >> key_bits >> entry.median_ns;
+        std::getline(fields >> std::ws, entry.algo);
+
+        if (!entry.algo.empty() && entry.algo.back() == '\r')
+            entry.algo.pop_back();
+
+        for (r = 0; r < NUM_RUN_CLASSES && runs != run_class_names[r]; ++r)
+            ;
+        for (d = 0; d < NUM_DUPLICATE_CLASSES && duplicates != duplicate_class_names[d];
+                ++d)
+            ;
+        for (b = 0; b < NUM_KEY_BITS_CLASSES && key_bits != key_bits_class_bits[b]; ++b)
+            ;
+
+        if (!fields || entry.algo.empty() || entry.features.size_log2 < 0 ||
+                entry.features.size_log2 >= NUM_SIZE_CLASSES || r == NUM_RUN_CLASSES ||
+                d == NUM_DUPLICATE_CLASSES || b == NUM_KEY_BITS_CLASSES) {
+            std::cerr << "ERROR: Malformed line " << line_number << " in calibration file "
+                << path << std::endl;
+            return false;
+        }
+
+        entry.features.runs = (RunClass) r;
+        entry.features.duplicates = (DuplicateClass) d;
+        entry.features.key_bits_class = b;
+        update_calibration(table, entry);
+    }
+
+    return true;
+}
+
+/*
+ * Save the calibration table to the file at the given path, one entry per
+ * line, ordered by element type and feature class. Return false, after
+ * notifying the user, if the file cannot be written.
+ */
+bool save_calibration (const char *path, const CalibrationTable& table)
+{
+    std::vector<CalibrationEntry> entries(table);  /* Entries in the order saved */
+    std::ofstream file(path);                      /* The calibration file */
+
+    if (!file) {
+        std::cerr << "ERROR: Failed to open calibration file " << path
+            << " for writing" << std::endl;
+        return false;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+        [] (const CalibrationEntry& e1, const CalibrationEntry& e2) {
+            if (e1.element_type != e2.element_type)
+                return e1.element_type < e2.element_type;
+            return feature_class_index(e1.features) < feature_class_index(e2.features);
+        });
+
+    file << "# Fastest algorithm measured on each feature class, written by"
+        " sortcomparer --calibration\n"
+        << "# type size_log2 runs duplicates key_bits median_ns algorithm\n";
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const FeatureClass& features = entries[i].features;  /* Class of the entry */
+
+        file << entries[i].element_type << ' ' << features.size_log2 << ' '
+            << run_class_names[features.runs] << ' '
+            << duplicate_class_names[features.duplicates] << ' '
+            << key_bits_class_bits[features.key_bits_class] << ' '
+            << std::fixed << std::setprecision(0) << entries[i].median_ns << ' '
+            << entries[i].algo << '\n';
+    }
+
+    file.flush();
+    if (!file) {
+        std::cerr << "ERROR: Failed to write calibration file " << path << std::endl;
+        return false;
+    }
+
+    return true;
+}
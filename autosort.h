@@ -0,0 +1,248 @@
+/**
+ * Auto Sort, a hybrid that sorts each list with whichever registered
+ * algorithm was fastest on similar datasets in earlier runs. A cheap probe
+ * reduces a list to its features: its length, the number of ascending runs
+ * in it, the fraction of duplicates among a sample of its elements, and
+ * the number of bits spanned by the range of its keys. The features are
+ * bucketed into a feature class, and Auto Sort looks the class up in a
+ * table filled from a calibration file, which records the fastest
+ * algorithm measured on each class, and dispatches to it. A class without
+ * measurements of its own takes the algorithm of the nearest class that
+ * has some. The probe runs inside the timed region, so Auto Sort's times
+ * include its overhead and show whether dispatching beats the best fixed
+ * choice.
+ *
+ * With --calibration FILE, the table is loaded from FILE before a run, and
+ * after the run the fastest algorithm on each dataset is recorded in it
+ * under the dataset's feature class and the element type, and it is saved
+ * back to FILE.
+ */
+
+#ifndef AUTOSORT_H
+#define AUTOSORT_H
+
+/* include statements */
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "radixsort.h"
+#include "registry.h"
+
+/* What the probe measured of a list */
+struct DatasetFeatures {
+    int n;              /* Length of the list */
+    long long runs;     /* Number of maximal ascending runs */
+    double duplicates;  /* Fraction of sampled neighbours that are equal */
+    int key_bits;       /* Bits spanned by the range of the keys */
+};
+
+/* How presorted a list is */
+enum RunClass {
+    RUNS_SORTED,    /* A single ascending run */
+    RUNS_REVERSED,  /* A single strictly descending run */
+    RUNS_FEW,       /* Few runs for its length */
+    RUNS_MANY       /* As many runs as an unsorted list */
+};
+
+/* How many duplicates a list holds */
+enum DuplicateClass {
+    DUPLICATES_LOW,
+    DUPLICATES_SOME,
+    DUPLICATES_HIGH
+};
+
+/* The bucketed features of a list, under which measurements are recorded */
+struct FeatureClass {
+    int size_log2;             /* floor(log2(n)), or 0 for an empty list */
+    RunClass runs;             /* How presorted it is */
+    DuplicateClass duplicates; /* How many duplicates it holds */
+    int key_bits_class;        /* 0 to 3, for keys spanning up to 8, 16, 32 or 64 bits */
+};
+
+/* The fastest algorithm measured on a feature class of one element type */
+struct CalibrationEntry {
+    std::string element_type;  /* Name of the element type, as given to --type */
+    FeatureClass features;     /* Class of the dataset it was measured on */
+    double median_ns;          /* Its median time on that dataset */
+    std::string algo;          /* Name of the algorithm */
+};
+
+/* using declarations */
+using CalibrationTable = std::vector<CalibrationEntry>;
+
+/* constants */
+const char AUTO_SORT_NAME[] = "Auto Sort";   /* Name Auto Sort is registered under */
+const int FEATURE_SAMPLE = 256;              /* Elements sampled for duplicates */
+const int FEW_RUNS_RATIO = 16;               /* A list with n / ratio runs or fewer has few */
+const double SOME_DUPLICATES = 1.0 / 16;     /* Least sampled duplicates that count as some */
+const double HIGH_DUPLICATES = 0.5;          /* Least sampled duplicates that count as high */
+const int NUM_SIZE_CLASSES = 32;             /* Values of FeatureClass::size_log2 */
+const int NUM_RUN_CLASSES = 4;               /* Values of RunClass */
+const int NUM_DUPLICATE_CLASSES = 3;         /* Values of DuplicateClass */
+const int NUM_KEY_BITS_CLASSES = 4;          /* Values of FeatureClass::key_bits_class */
+const int NUM_FEATURE_CLASSES = NUM_SIZE_CLASSES * NUM_RUN_CLASSES *
+    NUM_DUPLICATE_CLASSES * NUM_KEY_BITS_CLASSES;
+
+/* function declarations */
+template <typename T>
+void probe_features (const T *v, int n, DatasetFeatures& features);
+template <typename T>
+void auto_sort (T *v, int n);
+template <typename T>
+bool install_auto_sort (SortAlgoMap<T>& sort_algos, const CalibrationTable& table,
+    const char *element_type);
+template <typename T>
+SortAlgo<T> *auto_sort_choices ();
+void classify_features (const DatasetFeatures& features, FeatureClass& feature_class);
+int feature_class_index (const FeatureClass& feature_class);
+void feature_class_at (int index, FeatureClass& feature_class);
+int feature_distance (const FeatureClass& a, const FeatureClass& b);
+void describe_feature_class (const FeatureClass& feature_class, std::ostream& out);
+void update_calibration (CalibrationTable& table, const CalibrationEntry& entry);
+bool load_calibration (const char *path, CalibrationTable& table);
+bool save_calibration (const char *path, const CalibrationTable& table);
+
+/*
+ * Measure the features of the n elements of the given list, by their radix
+ * keys, in one pass over the list and a sort of a small sample of it.
+ */
+template <typename T>
+void probe_features (const T *v, int n, DatasetFeatures& features)
+{
+    using Traits = RadixTraits<T>;
+    using Key = typename Traits::Key;
+
+    Key sample[FEATURE_SAMPLE];  /* Keys of evenly spaced elements */
+    Key lo, hi;                  /* Smallest and largest keys */
+    Key previous;                /* Key of the element before the current one */
+    long long descents = 0;      /* Elements below the one before them */
+    int m;                       /* Number of keys sampled */
+    int equal = 0;               /* Sampled keys equal to the one before them */
+
+    features = DatasetFeatures{n, 0, 0, 0};
+    if (n == 0)
+        return;
+
+    lo = hi = previous = Traits::key(v[0]);
+
+    for (int i = 1; i < n; ++i) {
+        const Key key = Traits::key(v[i]);
+
+        descents += key < previous;
+        lo = std::min(lo, key);
+        hi = std::max(hi, key);
+        previous = key;
+    }
+
+    m = std::min(n, FEATURE_SAMPLE);
+    for (int j = 0; j < m; ++j)
+        sample[j] = Traits::key(v[(long long) j * n / m]);
+
+    std::sort(sample, sample + m);
+    for (int j = 1; j < m; ++j)
+        equal += sample[j] == sample[j - 1];
+
+    features.runs = descents + 1;
+    features.duplicates = m > 1 ? (double) equal / (m - 1) : 0;
+
+    for (Key range = hi - lo; range != 0; range >>= 1)
+        ++features.key_bits;
+}
+
+/*
+ * Sort the n elements of the given list in place with the algorithm
+ * installed for the feature class the probe puts them in.
+ */
+template <typename T>
+void auto_sort (T *v, int n)
+{
+    DatasetFeatures features;    /* What the probe measured */
+    FeatureClass feature_class;  /* Bucket the features fall in */
+
+    probe_features(v, n, features);
+    classify_features(features, feature_class);
+    auto_sort_choices<T>()[feature_class_index(feature_class)](v, n);
+}
+
+/*
+ * Choose an algorithm of the given map for every feature class, the one
+ * the calibration table records for the nearest class measured on the
+ * named element type, and register Auto Sort in the map to dispatch to
+ * them. Entries whose algorithm is quadratic are passed over, since Auto
+ * Sort is registered as an n log n sort and would otherwise escape the size
+ * cap and the timeout estimate on every class far from the one measured.
+ * Return whether the table has any usable entry for the type, without which
+ * Auto Sort is not registered.
+ */
+template <typename T>
+bool install_auto_sort (SortAlgoMap<T>& sort_algos, const CalibrationTable& table,
+    const char *element_type)
+{
+    std::vector<const CalibrationEntry *> entries;  /* Entries usable for the type */
+    SortAlgo<T> *choices = auto_sort_choices<T>();  /* Algorithm of each class */
+    bool uses_pool = false;                         /* Whether any choice uses the pool */
+
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        auto found = sort_algos.find(table[i].algo);
+
+        if (table[i].element_type == element_type && found != sort_algos.end() &&
+                found->second.kind == KIND_SORT && found->first != AUTO_SORT_NAME &&
+                found->second.complexity <= COMPLEXITY_N_LOG_N)
+            entries.push_back(&table[i]);
+    }
+
+    if (entries.empty())
+        return false;
+
+    for (int c = 0; c < NUM_FEATURE_CLASSES; ++c) {
+        FeatureClass feature_class;              /* Class c */
+        const CalibrationEntry *nearest = NULL;  /* Entry of the nearest class */
+        int nearest_distance = INT_MAX;          /* Distance to that class */
+
+        feature_class_at(c, feature_class);
+
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            const int distance = feature_distance(feature_class, entries[i]->features);
+
+            if (distance < nearest_distance) {
+                nearest = entries[i];
+                nearest_distance = distance;
+            }
+        }
+
+        const SortAlgoInfo<T>& chosen = sort_algos.at(nearest->algo);
+
+        choices[c] = chosen.sort;
+        uses_pool |= chosen.uses_pool;
+    }
+
+    sort_algos[AUTO_SORT_NAME] = SortAlgoInfo<T>{auto_sort<T>, COMPLEXITY_N_LOG_N,
+        uses_pool};
+    return true;
+}
+
+/*
+ * Return the table of the algorithm Auto Sort dispatches to on each
+ * feature class, for elements of type T. It is filled before any cell is
+ * measured, and only read while they are.
+ */
+template <typename T>
+SortAlgo<T> *auto_sort_choices ()
+{
+    static SortAlgo<T> choices[NUM_FEATURE_CLASSES];  /* Indexed by feature class */
+
+    return choices;
+}
+
+#endif // AUTOSORT_H
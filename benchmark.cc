@@ -0,0 +1,321 @@
+/**
+ * The timing engine behind the sort comparer. Each (algorithm, dataset) cell
+ * is measured by copying the pristine dataset into a scratch buffer outside
+ * the timed region, running a configurable number of untimed warmup runs,
+ * and then recording a series of timed trials with nanosecond resolution.
+ * The trials of a cell are reduced to min/median/p90/p99/stddev statistics
+ * for reporting.
+ *
+ * So that a single slow cell cannot stall a whole run, quadratic algorithms
+ * are skipped on datasets above a size cap, and with a timeout set, cells
+ * whose runtime extrapolated from smaller datasets exceeds the timeout are
+ * skipped, while cells whose runs overshoot it are abandoned after the run
+ * in progress completes.
+ *
+ * Algorithms take their buffers from the scratch arena of the measuring
+ * thread, which is reset before every run, so that no run allocates memory
+ * of its own or faults its pages in.
+ *
+ * The output of the first timed trial of every cell is verified against a
+ * fingerprint of the dataset, after the trial's clock has stopped, and a
+ * cell whose output is not a sorted permutation of its input is failed.
+ * The same output shows whether equal record keys kept their order. The
+ * top-k and selection algorithms are given a rank k, and their output only
+ * has to be in the order they promise for it.
+ *
+ * When performance counters are given, they are started and stopped around
+ * every timed trial, just outside the timed region, and each cell reports
+ * its mean counts per trial. Instrumented builds likewise report the mean
+ * numbers of comparisons, swaps and writes per trial.
+ */
+
+#include "benchmark.h"
+
+/*
+ * Measure the given algorithm on the n elements of the given dataset, whose
+ * fingerprint is reference, into cell, unless the size cap or the
+ * extrapolated runtime says it should be skipped. The trial runtimes are
+ * left in samples, and unless the output failed verification, the
+ * algorithm's history is updated so later datasets can be extrapolated
+ * from this one.
+ */
+template <typename T>
+void measure_cell (const SortAlgoInfo<T>& algo, const T *data, int n,
+    const Fingerprint& reference, std::vector<T>& scratch,
+    const BenchmarkOptions& options, const PerfCounters *counters,
+    RunHistory& history, std::vector<long long>& samples, CellResult& cell)
+{
+    CellStatus verdict = CELL_MEASURED;  /* Outcome of verifying the output */
+
+    cell.status = CELL_MEASURED;
+    cell.estimate_ns = 0;
+    clear_counter_values(counters, cell.counters);
+    cell.ops = OpCounts{0, 0, 0};
+    cell.stability = STABILITY_UNTESTED;
+    samples.clear();
+
+    if (algo.complexity == COMPLEXITY_QUADRATIC &&
+            n > options.max_quadratic_n) {
+        cell.status = CELL_SKIPPED_SIZE;
+    } else if (options.timeout_ns > 0 && history.n > 0 &&
+            estimate_runtime(algo.complexity, history, n) > options.timeout_ns) {
+        cell.status = CELL_SKIPPED_ESTIMATE;
+        cell.estimate_ns = estimate_runtime(algo.complexity, history, n);
+    } else if (!run_trials(algo, data, n, reference, scratch, options, counters,
+            samples, cell.counters, cell.ops, verdict, cell.stability)) {
+        cell.status = CELL_ABORTED;
+    }
+
+    if (verdict != CELL_MEASURED)
+        cell.status = verdict;
+
+    compute_trial_stats(samples, cell.stats);
+
+    if (!samples.empty()) {
+        scale_counter_values(cell.counters, 1.0 / samples.size());
+        cell.ops.comparisons /= samples.size();
+        cell.ops.swaps /= samples.size();
+        cell.ops.writes /= samples.size();
+    }
+
+    if (!samples.empty() && n >= history.n && verdict == CELL_MEASURED) {
+        history.n = n;
+        history.median_ns = cell.stats.median;
+    }
+}
+
+/*
+ * Measure the given sorting algorithm on the n elements of the given
+ * dataset, appending the runtime of each timed trial in nanoseconds to
+ * samples. Before every run, warmup or timed, the scratch buffer is refilled
+ * from the pristine dataset and the thread's scratch arena, if it has one,
+ * is reset, so that each run sorts the same input and only the sort itself
+ * is timed.
+ * If a time budget is set, trials continue past the minimum trial count
+ * until the measured time reaches the budget. If a timeout is set and any
+ * run exceeds it, no further runs are made and false is returned; the
+ * overlong run is still recorded if it was a timed trial. If counters are
+ * given, their counts over each timed trial are added to counter_totals,
+ * and in instrumented builds the operations of each timed trial are added
+ * to op_totals. The output of the first timed trial is checked against the
+ * reference fingerprint of the dataset, and for the order its algorithm's
+ * kind promises, and verdict is set to CELL_CORRUPTED or CELL_UNSORTED if
+ * it fails, and otherwise left as is, while stability is set to what the
+ * output of a sort shows about the algorithm's stability. Top-k and
+ * selection algorithms are given the rank options.k.
+ */
+template <typename T>
+bool run_trials (const SortAlgoInfo<T>& algo, const T *data, int n,
+    const Fingerprint& reference, std::vector<T>& scratch,
+    const BenchmarkOptions& options, const PerfCounters *counters,
+    std::vector<long long>& samples, CounterValues& counter_totals,
+    OpCounts& op_totals, CellStatus& verdict, Stability& stability)
+{
+    int i;                 /* Index */
+    long long spent_ns;    /* Total measured time so far */
+    long long duration;    /* Runtime of the current run */
+    ScratchArena *arena = current_scratch_arena();  /* Memory of the algorithms' buffers */
+
+    for (i = 0; i < options.warmup_runs; ++i) {
+        std::copy(data, data + n, scratch.begin());
+        if (arena)
+            reset_scratch_arena(*arena);
+
+        Clock::time_point start_time = Clock::now();
+        run_algo(algo, scratch.data(), n, options.k);
+        Clock::time_point end_time = Clock::now();
+
+        duration = std::chrono::duration_cast<std::chrono::nanoseconds>
+            (end_time - start_time).count();
+
+        if (options.timeout_ns > 0 && duration > options.timeout_ns)
+            return false;
+    }
+
+    spent_ns = 0;
+
+    for (i = 0; i < options.trials ||
+            (spent_ns < options.budget_ns && i < MAX_BUDGET_TRIALS); ++i) {
+        std::copy(data, data + n, scratch.begin());
+        if (arena)
+            reset_scratch_arena(*arena);
+
+#ifdef SORTCOMPARER_COUNT_OPS
+        reset_op_counts();
+#endif
+
+        if (counters)
+            start_perf_counters(*counters);
+
+        Clock::time_point start_time = Clock::now();
+        run_algo(algo, scratch.data(), n, options.k);
+        Clock::time_point end_time = Clock::now();
+
+        if (counters)
+            stop_perf_counters(*counters, counter_totals);
+
+#ifdef SORTCOMPARER_COUNT_OPS
+        add_op_counts(op_totals);
+#else
+        (void) op_totals;
+#endif
+
+        if (i == 0) {
+            Fingerprint output;  /* Fingerprint of the sorted elements */
+            bool ordered;        /* Whether the output is in the order its kind promises */
+
+            ordered = fingerprint_elements(scratch.data(), n, output);
+            if (algo.kind == KIND_TOP_K)
+                ordered = check_top_k(scratch.data(), n, options.k);
+            else if (algo.kind == KIND_SELECT)
+                ordered = check_selected(scratch.data(), n, options.k);
+
+            if (!ordered)
+                verdict = CELL_UNSORTED;
+            if (!same_fingerprint(output, reference))
+                verdict = CELL_CORRUPTED;
+
+            if (algo.kind == KIND_SORT)
+                stability = check_stability(scratch.data(), n);
+        }
+
+        duration = std::chrono::duration_cast<std::chrono::nanoseconds>
+            (end_time - start_time).count();
+
+        samples.push_back(duration);
+        spent_ns += duration;
+
+        if (options.timeout_ns > 0 && duration > options.timeout_ns)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Run the given algorithm on the n elements of the given list, passing it
+ * the rank k if it takes one.
+ */
+template <typename T>
+void run_algo (const SortAlgoInfo<T>& algo, T *v, int n, int k)
+{
+    if (algo.kind == KIND_SORT)
+        algo.sort(v, n);
+    else
+        algo.select(v, n, k);
+}
+
+/*
+ * Predict the runtime in nanoseconds of an algorithm with the given
+ * complexity on a dataset of length n, by scaling its time on the largest
+ * dataset in its history.
+ */
+double estimate_runtime (Complexity complexity, const RunHistory& history, int n)
+{
+    return history.median_ns * complexity_growth(complexity, n) /
+        complexity_growth(complexity, history.n);
+}
+
+/*
+ * Return the growth function of the given complexity, evaluated at n.
+ */
+double complexity_growth (Complexity complexity, double n)
+{
+    switch (complexity) {
+    case COMPLEXITY_LINEAR:
+        return n;
+    case COMPLEXITY_N_LOG_N:
+        return n * std::log2(std::max(n, 2.0));
+    case COMPLEXITY_QUADRATIC:
+    default:
+        return n * n;
+    }
+}
+
+/*
+ * Reduce the given list of trial runtimes to summary statistics. The samples
+ * are left in the order the trials ran.
+ */
+void compute_trial_stats (const std::vector<long long>& trial_samples, TrialStats& stats)
+{
+    double sum;       /* Sum of all samples */
+    double sq_diffs;  /* Sum of squared differences from the mean */
+    int n;            /* Number of samples */
+
+    n = trial_samples.size();
+    stats.trials = n;
+
+    if (n == 0) {
+        stats.min = stats.median = stats.p90 = stats.p99 = 0;
+        stats.mean = stats.stddev = 0;
+        return;
+    }
+
+    std::vector<long long> samples(trial_samples);
+    std::sort(samples.begin(), samples.end());
+
+    sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += samples[i];
+
+    stats.mean = sum / n;
+
+    sq_diffs = 0;
+    for (int i = 0; i < n; ++i)
+        sq_diffs += (samples[i] - stats.mean) * (samples[i] - stats.mean);
+
+    stats.stddev = n > 1 ? std::sqrt(sq_diffs / (n - 1)) : 0;
+    stats.min = samples[0];
+    stats.median = percentile(samples, 50);
+    stats.p90 = percentile(samples, 90);
+    stats.p99 = percentile(samples, 99);
+}
+
+/*
+ * Return the p-th percentile of the given sorted, non-empty list of samples,
+ * linearly interpolating between the two closest ranks.
+ */
+double percentile (const std::vector<long long>& sorted_samples, double p)
+{
+    double rank;   /* Fractional index of the percentile */
+    int lower;     /* Index of the closest rank at or below it */
+
+    rank = (p / 100) * (sorted_samples.size() - 1);
+    lower = (int) rank;
+
+    if (lower + 1 >= (int) sorted_samples.size())
+        return sorted_samples.back();
+
+    return sorted_samples[lower] +
+        (rank - lower) * (sorted_samples[lower + 1] - sorted_samples[lower]);
+}
+
+/*
+ * Add the statistics of one cell into the running totals for an algorithm.
+ * Each order statistic is summed across cells, while the standard deviations
+ * are combined as though the cells were independent.
+ */
+void accumulate_trial_stats (TrialStats& total, const TrialStats& stats)
+{
+    total.min += stats.min;
+    total.median += stats.median;
+    total.p90 += stats.p90;
+    total.p99 += stats.p99;
+    total.mean += stats.mean;
+    total.stddev = std::sqrt(total.stddev * total.stddev +
+        stats.stddev * stats.stddev);
+    total.trials += stats.trials;
+}
+
+#define INSTANTIATE_BENCHMARK(T) \
+    template void measure_cell<T> (const SortAlgoInfo<T>& algo, const T *data, \
+        int n, const Fingerprint& reference, std::vector<T>& scratch, \
+        const BenchmarkOptions& options, const PerfCounters *counters, \
+        RunHistory& history, std::vector<long long>& samples, CellResult& cell); \
+    template bool run_trials<T> (const SortAlgoInfo<T>& algo, const T *data, int n, \
+        const Fingerprint& reference, std::vector<T>& scratch, \
+        const BenchmarkOptions& options, const PerfCounters *counters, \
+        std::vector<long long>& samples, CounterValues& counter_totals, \
+        OpCounts& op_totals, CellStatus& verdict, Stability& stability);
+
+FOR_EACH_ELEMENT_TYPE(INSTANTIATE_BENCHMARK)
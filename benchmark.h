@@ -0,0 +1,151 @@
+/**
+ * The timing engine behind the sort comparer. Each (algorithm, dataset) cell
+ * is measured by copying the pristine dataset into a scratch buffer outside
+ * the timed region, running a configurable number of untimed warmup runs,
+ * and then recording a series of timed trials with nanosecond resolution.
+ * The trials of a cell are reduced to min/median/p90/p99/stddev statistics
+ * for reporting.
+ *
+ * So that a single slow cell cannot stall a whole run, quadratic algorithms
+ * are skipped on datasets above a size cap, and with a timeout set, cells
+ * whose runtime extrapolated from smaller datasets exceeds the timeout are
+ * skipped, while cells whose runs overshoot it are abandoned after the run
+ * in progress completes.
+ *
+ * Algorithms take their buffers from the scratch arena of the measuring
+ * thread, which is reset before every run, so that no run allocates memory
+ * of its own or faults its pages in.
+ *
+ * The output of the first timed trial of every cell is verified against a
+ * fingerprint of the dataset, after the trial's clock has stopped, and a
+ * cell whose output is not a sorted permutation of its input is failed.
+ * The same output shows whether equal record keys kept their order. The
+ * top-k and selection algorithms are given a rank k, and their output only
+ * has to be in the order they promise for it.
+ *
+ * When performance counters are given, they are started and stopped around
+ * every timed trial, just outside the timed region, and each cell reports
+ * its mean counts per trial. Instrumented builds likewise report the mean
+ * numbers of comparisons, swaps and writes per trial.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/* include statements */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "elementtypes.h"
+#include "opcount.h"
+#include "perfcounters.h"
+#include "scratcharena.h"
+#include "verification.h"
+
+/* using declarations */
+using Clock = std::chrono::steady_clock;
+template <typename T>
+using SortAlgo = void (*) (T *, int);
+template <typename T>
+using SelectAlgo = void (*) (T *, int, int);
+
+/* How the running time of an algorithm grows with the length of its input,
+ * used to predict its time on larger datasets */
+enum Complexity {
+    COMPLEXITY_LINEAR,
+    COMPLEXITY_N_LOG_N,
+    COMPLEXITY_QUADRATIC
+};
+
+/* What a registered algorithm leaves in the list it is given */
+enum AlgoKind {
+    KIND_SORT,    /* Every element in order */
+    KIND_TOP_K,   /* The k smallest elements in order at the front */
+    KIND_SELECT   /* The k-th smallest element in place, partitioned around */
+};
+
+/* A registered sorting algorithm for elements of type T */
+template <typename T>
+struct SortAlgoInfo {
+    SortAlgo<T> sort;       /* Implementation function, if it sorts */
+    Complexity complexity;  /* Growth of its typical running time */
+    bool uses_pool;         /* Whether it runs tasks on a thread pool, ours or a library's */
+    SelectAlgo<T> select;   /* Implementation function, if it takes a rank k */
+    AlgoKind kind;          /* What it leaves in the list */
+};
+
+/* Settings controlling how many times each cell is measured */
+struct BenchmarkOptions {
+    int warmup_runs;       /* Untimed runs before measurement begins */
+    int trials;            /* Minimum number of timed trials per cell */
+    long long budget_ns;   /* Keep measuring until this much time is spent, if > 0 */
+    long long timeout_ns;  /* Abandon or skip cells taking longer than this, if > 0 */
+    int max_quadratic_n;   /* Skip quadratic algorithms on datasets longer than this */
+    int k;                 /* Rank given to the top-k and selection algorithms */
+};
+
+/* Statistics over the timed trials of one cell, all in nanoseconds */
+struct TrialStats {
+    double min;
+    double median;
+    double p90;
+    double p99;
+    double mean;
+    double stddev;
+    int trials;
+};
+
+/* What happened when a cell was measured */
+enum CellStatus {
+    CELL_MEASURED,          /* All trials ran */
+    CELL_SKIPPED_SIZE,      /* Quadratic algorithm on a dataset above the size cap */
+    CELL_SKIPPED_ESTIMATE,  /* Predicted to take longer than the timeout */
+    CELL_ABORTED,           /* A run took longer than the timeout */
+    CELL_UNSORTED,          /* The output was not in order */
+    CELL_CORRUPTED          /* The output held other elements than the input */
+};
+
+/* The outcome of measuring one (algorithm, dataset) cell */
+struct CellResult {
+    CellStatus status;
+    TrialStats stats;       /* Statistics over the trials that ran */
+    double estimate_ns;     /* Predicted runtime, if the cell was skipped for it */
+    CounterValues counters; /* Mean event counts per timed trial */
+    OpCounts ops;           /* Mean operation counts per timed trial, if counted */
+    Stability stability;    /* What the output showed about the algorithm's stability */
+};
+
+/* The largest dataset an algorithm has been timed on so far, from which its
+ * time on larger datasets is extrapolated */
+struct RunHistory {
+    int n;                  /* Length of the dataset, or 0 if none yet */
+    double median_ns;       /* Median time taken on it */
+};
+
+/* Upper bound on the number of trials a time budget may add to a cell */
+const int MAX_BUDGET_TRIALS = 100000;
+
+/* function declarations */
+template <typename T>
+void measure_cell (const SortAlgoInfo<T>& algo, const T *data, int n,
+    const Fingerprint& reference, std::vector<T>& scratch,
+    const BenchmarkOptions& options, const PerfCounters *counters,
+    RunHistory& history, std::vector<long long>& samples, CellResult& cell);
+template <typename T>
+bool run_trials (const SortAlgoInfo<T>& algo, const T *data, int n,
+    const Fingerprint& reference, std::vector<T>& scratch,
+    const BenchmarkOptions& options, const PerfCounters *counters,
+    std::vector<long long>& samples, CounterValues& counter_totals,
+    OpCounts& op_totals, CellStatus& verdict, Stability& stability);
+template <typename T>
+void run_algo (const SortAlgoInfo<T>& algo, T *v, int n, int k);
+double estimate_runtime (Complexity complexity, const RunHistory& history, int n);
+double complexity_growth (Complexity complexity, double n);
+void compute_trial_stats (const std::vector<long long>& trial_samples, TrialStats& stats);
+double percentile (const std::vector<long long>& sorted_samples, double p);
+void accumulate_trial_stats (TrialStats& total, const TrialStats& stats);
+
+#endif // BENCHMARK_H
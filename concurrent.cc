@@ -0,0 +1,316 @@
+/**
+ * Concurrent measurement of the (algorithm, dataset) cells. With --jobs N,
+ * the cells are handed in dataset order to N job workers, each pinned to
+ * its own CPU: one CPU of every physical core is used before any second
+ * hardware thread of a core, and with --isolate no two workers ever share a
+ * physical core. Each worker converts its datasets into buffers of its own
+ * and first touches its scratch buffer and scratch arena itself, so that on
+ * NUMA machines all of them are placed on the worker's node, and with
+ * --numa-local the pristine dataset is also copied to the worker before
+ * being converted. Algorithms that run tasks on the shared thread pool are
+ * measured afterwards, one cell at a time, so that they have the machine to
+ * themselves.
+ *
+ * Since workers contend for memory bandwidth and shared caches, a sample of
+ * the cells measured concurrently is measured again serially once all jobs
+ * are done, and each is checked for interference with the same test used
+ * for baseline comparisons.
+ */
+
+#include "concurrent.h"
+
+/*
+ * Measure every registered algorithm on every dataset, passing each cell
+ * to record as it completes, with calls to record serialized. The cells of
+ * algorithms that do not use the thread pool are measured by one job worker
+ * per CPU in cpus, and those of algorithms that do are measured afterwards
+ * on the calling thread. One in INTERFERENCE_SAMPLE_RATIO of the cells
+ * measured by the workers is then measured again on the calling thread,
+ * and the outcomes are appended to checks. Both sides of a check take at
+ * least BASELINE_MIN_TRIALS trials, so that it can be tested whatever
+ * --trials is. Performance counters are not
+ * supported, since they count every thread of the process at once.
+ */
+template <typename T>
+void run_concurrent_cells (const SortAlgoMap<T>& sort_algos,
+    const std::vector<DatasetView>& datasets, const BenchmarkOptions& options,
+    const std::vector<CpuInfo>& cpus, bool numa_local, const CellRecorder& record,
+    std::vector<InterferenceCheck>& checks)
+{
+    std::vector<std::string> names;       /* Algorithms measured by the workers */
+    std::vector<std::string> pool_names;  /* Algorithms measured afterwards */
+    std::unordered_map<std::string, RunHistory> histories;  /* Shared by the workers */
+    std::map<int, std::vector<long long> > sampled;  /* Worker trials of the cells to check */
+    std::mutex mutex;                     /* Guards histories, sampled and record */
+    std::atomic<int> next_job(0);         /* Index of the next cell to hand out */
+    std::atomic<bool> pinned(true);       /* Whether every worker could be pinned */
+    std::atomic<long long> overflows(0);  /* Scratch allocations that missed the arenas */
+    std::vector<std::thread> workers;     /* One thread per CPU in cpus */
+    int max_dataset_size = 0;             /* Length of the longest dataset */
+    BenchmarkOptions check_options = options;  /* Settings of the checked cells */
+
+    check_options.trials = std::max(options.trials, BASELINE_MIN_TRIALS);
+
+    for (auto iter = sort_algos.begin(); iter != sort_algos.end(); ++iter) {
+        (iter->second.uses_pool ? pool_names : names).push_back(iter->first);
+        histories[iter->first] = RunHistory{0, 0};
+    }
+
+    std::sort(names.begin(), names.end());
+    std::sort(pool_names.begin(), pool_names.end());
+
+    for (std::size_t i = 0; i < datasets.size(); ++i)
+        max_dataset_size = std::max(max_dataset_size, datasets[i].size);
+
+    const int num_names = names.size();
+    const int num_jobs = datasets.size() * num_names;
+
+    /* Each worker claims the next cell in dataset order, reusing the dataset
+     * it last converted when the cell is on the same dataset. */
+    auto worker = [&] (int index) {
+        std::vector<T> scratch(max_dataset_size);  /* First touched by this worker */
+        std::vector<T> elements;                   /* Current dataset as elements */
+        std::vector<int> local;                    /* Worker's copy of the dataset */
+        std::vector<long long> samples;            /* Trial times of the current cell */
+        std::vector<long long> check_samples;      /* Trial times of the cell to check */
+        const T *data = NULL;                      /* Elements of the current dataset */
+        Fingerprint reference;                     /* Fingerprint of the current dataset */
+        int loaded = -1;                           /* Dataset held in elements */
+
+        ScratchArena arena;                        /* Memory of the algorithms' buffers */
+
+        if (!pin_current_thread(cpus[index].cpu))
+            pinned = false;
+
+        if (create_scratch_arena(arena, scratch_arena_bytes(max_dataset_size * sizeof(T))))
+            use_scratch_arena(&arena);
+
+        for (int job = next_job++; job < num_jobs; job = next_job++) {
+            const int i = job / num_names;
+            const std::string& algo = names[job % num_names];
+            RunHistory history;
+            CellResult cell;
+
+            if (i != loaded) {
+                DatasetView view = datasets[i];
+
+                if (numa_local) {
+                    local.assign(view.data, view.data + view.size);
+                    view.data = local.data();
+                }
+
+                data = convert_dataset(view, elements);
+                fingerprint_elements(data, view.size, reference);
+                loaded = i;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                history = histories[algo];
+            }
+
+            measure_cell(sort_algos.at(algo), data, datasets[i].size, reference, scratch,
+                options, NULL, history, samples, cell);
+
+            bool check = job % INTERFERENCE_SAMPLE_RATIO == 0 && cell.status == CELL_MEASURED;
+
+            /* A cell to check with too few trials for the test is measured
+             * again here, with enough of them, leaving its record as it is */
+            if (check && (int) samples.size() < BASELINE_MIN_TRIALS) {
+                RunHistory check_history = RunHistory{0, 0};
+                CellResult check_cell;
+
+                measure_cell(sort_algos.at(algo), data, datasets[i].size, reference,
+                    scratch, check_options, NULL, check_history, check_samples, check_cell);
+                check = check_cell.status == CELL_MEASURED;
+            } else {
+                check_samples = samples;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (history.n > histories[algo].n)
+                histories[algo] = history;
+
+            if (check)
+                sampled[job] = check_samples;
+
+            record(i, algo, cell, samples);
+        }
+
+        overflows += arena.overflows;
+        use_scratch_arena(NULL);
+        destroy_scratch_arena(arena);
+    };
+
+    for (std::size_t w = 0; w < cpus.size(); ++w)
+        workers.emplace_back(worker, w);
+
+    for (std::size_t w = 0; w < workers.size(); ++w)
+        workers[w].join();
+
+    if (!pinned)
+        std::cerr << "WARNING: Failed to pin every job worker to its CPU" << std::endl;
+
+    /* The remaining cells and checks run on this thread alone */
+    std::vector<T> scratch(max_dataset_size);
+    std::vector<T> elements;
+    std::vector<long long> samples;
+    ScratchArena arena;
+
+    if (create_scratch_arena(arena, scratch_arena_bytes(max_dataset_size * sizeof(T))))
+        use_scratch_arena(&arena);
+
+    for (std::size_t i = 0; i < datasets.size() && !pool_names.empty(); ++i) {
+        const T *data = convert_dataset(datasets[i], elements);
+        Fingerprint reference;
+
+        fingerprint_elements(data, datasets[i].size, reference);
+
+        for (std::size_t a = 0; a < pool_names.size(); ++a) {
+            CellResult cell;
+
+            measure_cell(sort_algos.at(pool_names[a]), data, datasets[i].size, reference,
+                scratch, options, NULL, histories[pool_names[a]], samples, cell);
+            record(i, pool_names[a], cell, samples);
+        }
+    }
+
+    for (auto iter = sampled.begin(); iter != sampled.end(); ++iter) {
+        const int i = iter->first / num_names;
+        const std::string& algo = names[iter->first % num_names];
+        const T *data = convert_dataset(datasets[i], elements);
+        RunHistory history = RunHistory{0, 0};
+        Fingerprint reference;
+        CellResult cell;
+
+        fingerprint_elements(data, datasets[i].size, reference);
+        measure_cell(sort_algos.at(algo), data, datasets[i].size, reference, scratch,
+            check_options, NULL, history, samples, cell);
+
+        if (cell.status != CELL_MEASURED)
+            continue;
+
+        checks.push_back(InterferenceCheck{algo, i + 1, BaselineComparison()});
+        compare_with_baseline(samples, iter->second, INTERFERENCE_THRESHOLD,
+            checks.back().comparison);
+    }
+
+    overflows += arena.overflows;
+    use_scratch_arena(NULL);
+    destroy_scratch_arena(arena);
+
+    if (overflows > 0)
+        std::cerr << "WARNING: " << overflows << " scratch allocations did not fit in "
+            "the arenas and were made on the heap" << std::endl;
+}
+
+/*
+ * Choose the CPUs of the job workers of a concurrent run into cpus, one
+ * per worker, from the CPUs this process may run on. Every physical core
+ * contributes one CPU before any core contributes a second. With isolate
+ * set, workers never share a core, so there are no more workers than
+ * cores; otherwise, if there are more workers than CPUs, CPUs are reused.
+ */
+void assign_job_cpus (const ConcurrentOptions& concurrent, std::vector<CpuInfo>& cpus)
+{
+    std::vector<CpuInfo> available;  /* CPUs in the order they are handed out */
+
+    list_job_cpus(concurrent.isolate, available);
+    cpus.clear();
+
+    for (int w = 0; w < concurrent.jobs && !available.empty(); ++w) {
+        if (concurrent.isolate && w >= (int) available.size())
+            break;
+
+        cpus.push_back(available[w % available.size()]);
+    }
+}
+
+/*
+ * List the CPUs this process may run on into cpus, with the first CPU of
+ * each physical core ahead of the others, which are left out entirely if
+ * isolate is set.
+ */
+void list_job_cpus (bool isolate, std::vector<CpuInfo>& cpus)
+{
+#ifdef __linux__
+    cpu_set_t allowed;                         /* CPUs this process may run on */
+    std::set<std::pair<int, int> > seen;       /* Physical cores already listed */
+#endif
+    std::vector<CpuInfo> siblings;             /* Further CPUs of listed cores */
+
+    cpus.clear();
+
+#ifdef __linux__
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        cpus.push_back(CpuInfo{0, 0, 0});
+        return;
+    }
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed))
+            continue;
+
+        int package = read_topology_value(cpu, "physical_package_id");
+        int core = read_topology_value(cpu, "core_id");
+        CpuInfo info = CpuInfo{cpu, package, core < 0 ? cpu : core};
+
+        if (seen.insert(std::make_pair(info.package, info.core)).second)
+            cpus.push_back(info);
+        else
+            siblings.push_back(info);
+    }
+
+#else
+    /* Without affinity information every CPU counts as a core of its own */
+    for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+        cpus.push_back(CpuInfo{(int) cpu, 0, (int) cpu});
+#endif
+
+    if (!isolate)
+        cpus.insert(cpus.end(), siblings.begin(), siblings.end());
+}
+
+/*
+ * Return the value of the named topology attribute of the given CPU from
+ * sysfs, or -1 if it cannot be read.
+ */
+int read_topology_value (int cpu, const char *name)
+{
+    std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+        "/topology/" + name);
+    int value;
+
+    if (!(file >> value))
+        return -1;
+
+    return value;
+}
+
+/*
+ * Restrict the calling thread to the given CPU, returning whether it could
+ * be.
+ */
+bool pin_current_thread (int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;  /* The single CPU to run on */
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void) cpu;
+    return false;
+#endif
+}
+
+#define INSTANTIATE_CONCURRENT(T) \
+    template void run_concurrent_cells<T> (const SortAlgoMap<T>& sort_algos, \
+        const std::vector<DatasetView>& datasets, const BenchmarkOptions& options, \
+        const std::vector<CpuInfo>& cpus, bool numa_local, const CellRecorder& record, \
+        std::vector<InterferenceCheck>& checks);
+
+FOR_EACH_ELEMENT_TYPE(INSTANTIATE_CONCURRENT)
@@ -0,0 +1,88 @@
+/**
+ * Concurrent measurement of the (algorithm, dataset) cells. With --jobs N,
+ * the cells are handed in dataset order to N job workers, each pinned to
+ * its own CPU: one CPU of every physical core is used before any second
+ * hardware thread of a core, and with --isolate no two workers ever share a
+ * physical core. Each worker converts its datasets into buffers of its own
+ * and first touches its scratch buffer and scratch arena itself, so that on
+ * NUMA machines all of them are placed on the worker's node, and with
+ * --numa-local the pristine dataset is also copied to the worker before
+ * being converted. Algorithms that run tasks on the shared thread pool are
+ * measured afterwards, one cell at a time, so that they have the machine to
+ * themselves.
+ *
+ * Since workers contend for memory bandwidth and shared caches, a sample of
+ * the cells measured concurrently is measured again serially once all jobs
+ * are done, and each is checked for interference with the same test used
+ * for baseline comparisons.
+ */
+
+#ifndef CONCURRENT_H
+#define CONCURRENT_H
+
+/* include statements */
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "benchmark.h"
+#include "datasetio.h"
+#include "elementtypes.h"
+#include "registry.h"
+#include "regression.h"
+
+/* Settings of a concurrent run */
+struct ConcurrentOptions {
+    int jobs;           /* Number of job workers, or 1 to run serially */
+    bool isolate;       /* Whether each worker gets a physical core to itself */
+    bool numa_local;    /* Whether workers copy each dataset before converting it */
+};
+
+/* A CPU that a job worker can be pinned to */
+struct CpuInfo {
+    int cpu;            /* Index of the logical CPU */
+    int package;        /* Physical package it belongs to */
+    int core;           /* Physical core within the package */
+};
+
+/* A concurrently measured cell measured again serially */
+struct InterferenceCheck {
+    std::string algo;               /* Name of the algorithm */
+    int dataset;                    /* Index of the dataset */
+    BaselineComparison comparison;  /* Concurrent times against serial times */
+};
+
+/* using declarations */
+using CellRecorder = std::function<void (int dataset, const std::string& algo,
+    const CellResult& cell, const std::vector<long long>& samples)>;
+
+/* constants */
+const int INTERFERENCE_SAMPLE_RATIO = 10;     /* One cell in this many is measured again */
+const double INTERFERENCE_THRESHOLD = 0.05;   /* Slowdown that counts as interference */
+
+/* function declarations */
+template <typename T>
+void run_concurrent_cells (const SortAlgoMap<T>& sort_algos,
+    const std::vector<DatasetView>& datasets, const BenchmarkOptions& options,
+    const std::vector<CpuInfo>& cpus, bool numa_local, const CellRecorder& record,
+    std::vector<InterferenceCheck>& checks);
+void assign_job_cpus (const ConcurrentOptions& concurrent, std::vector<CpuInfo>& cpus);
+void list_job_cpus (bool isolate, std::vector<CpuInfo>& cpus);
+int read_topology_value (int cpu, const char *name);
+bool pin_current_thread (int cpu);
+
+#endif // CONCURRENT_H
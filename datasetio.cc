@@ -0,0 +1,526 @@
+/**
+ * Loading of the input datasets. The text format has one dataset per line,
+ * each a whitespace-separated list of integers, and ends at the first blank
+ * line or at the end of the input. Input is read in large blocks from stdin,
+ * or memory-mapped when a file path is given, and integers are parsed by a
+ * hand-written scanner directly into the destination datasets.
+ *
+ * Datasets can also be stored in a compact binary format, which is mapped
+ * into memory and used in place without any parsing or copying. A binary
+ * file holds a BinaryHeader, then one BinaryDatasetEntry per dataset, then
+ * the elements of each dataset at the offset its entry gives, aligned to
+ * BINARY_ALIGNMENT bytes. All fields are in the byte order of the machine
+ * that wrote the file.
+ */
+
+#include "datasetio.h"
+
+/*
+ * Return whether the given character separates the elements of a dataset.
+ */
+static inline bool is_blank (char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/*
+ * Load the datasets in the given file, or on stdin if path is NULL, into the
+ * given store, and point one view at each. Binary dataset files are
+ * recognized by their magic number and mapped; anything else is parsed as
+ * text. Return false, after notifying the user, if the input is unusable.
+ */
+bool load_datasets (DatasetStore& store, const char *path)
+{
+    store.mapping = NULL;
+    store.mapping_length = 0;
+    store.views.clear();
+    store.labels.clear();
+
+    if (path && is_binary_dataset_file(path))
+        return load_binary_datasets(store, path);
+
+    if (!read_in_datasets(store.parsed, path))
+        return false;
+
+    store.views.reserve(store.parsed.size());
+    for (std::size_t i = 0; i < store.parsed.size(); ++i)
+        store.views.push_back(DatasetView{store.parsed[i].data(),
+            (int) store.parsed[i].size()});
+
+    return true;
+}
+
+/*
+ * Release the storage behind the views of the given store, invalidating
+ * them.
+ */
+void release_datasets (DatasetStore& store)
+{
+    if (store.mapping)
+        munmap(store.mapping, store.mapping_length);
+
+    store.mapping = NULL;
+    store.mapping_length = 0;
+    store.parsed.clear();
+    store.views.clear();
+    store.labels.clear();
+}
+
+/*
+ * Return whether the file at the given path begins with the magic number of
+ * a binary dataset file.
+ */
+bool is_binary_dataset_file (const char *path)
+{
+    char magic[sizeof(BINARY_MAGIC)];  /* First bytes of the file */
+    int fd;                            /* Descriptor of the file */
+    bool matches;                      /* Whether the magic number matched */
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    matches = read(fd, magic, sizeof(magic)) == (ssize_t) sizeof(magic) &&
+        !std::memcmp(magic, BINARY_MAGIC, sizeof(magic));
+
+    close(fd);
+    return matches;
+}
+
+/*
+ * Notify the user that the binary dataset file at the given path is
+ * malformed, and return false.
+ */
+static bool binary_file_error (const char *path, const char *problem)
+{
+    std::cerr << "ERROR: Invalid binary dataset file " << path << ": "
+        << problem << std::endl;
+    return false;
+}
+
+/*
+ * Map the binary dataset file at the given path into the given store and
+ * point one view directly into the mapping for each dataset. The header and
+ * directory are validated against the size of the file, and if the file
+ * carries checksums each dataset is verified against its own. Return false,
+ * after notifying the user, if the file cannot be used.
+ */
+bool load_binary_datasets (DatasetStore& store, const char *path)
+{
+    int fd;                /* Descriptor of the input file */
+    struct stat info;      /* Size of the input file */
+    void *mapping;         /* Address of the mapped file */
+    std::size_t length;    /* Length of the file in bytes */
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &info) < 0) {
+        std::cerr << "ERROR: Could not open input file " << path << ": "
+            << std::strerror(errno) << std::endl;
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+
+    length = info.st_size;
+    if (length < sizeof(BinaryHeader)) {
+        close(fd);
+        return binary_file_error(path, "truncated header");
+    }
+
+    mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        std::cerr << "ERROR: Could not map input file " << path << ": "
+            << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    store.mapping = mapping;
+    store.mapping_length = length;
+
+    const char *base = static_cast<const char *>(mapping);
+    const BinaryHeader *header = reinterpret_cast<const BinaryHeader *>(base);
+    const BinaryDatasetEntry *entries =
+        reinterpret_cast<const BinaryDatasetEntry *>(base + sizeof(BinaryHeader));
+
+    if (header->version != BINARY_VERSION) {
+        release_datasets(store);
+        return binary_file_error(path, "unsupported format version");
+    }
+
+    if (header->element_type != BINARY_TYPE_INT32) {
+        release_datasets(store);
+        return binary_file_error(path, "unsupported element type");
+    }
+
+    if (header->num_datasets > (length - sizeof(BinaryHeader)) /
+            sizeof(BinaryDatasetEntry)) {
+        release_datasets(store);
+        return binary_file_error(path, "truncated dataset directory");
+    }
+
+    store.views.reserve(header->num_datasets);
+
+    for (std::uint64_t i = 0; i < header->num_datasets; ++i) {
+        const BinaryDatasetEntry& entry = entries[i];
+
+        if (entry.offset % alignof(int) != 0 || entry.offset > length ||
+                entry.length > (length - entry.offset) / sizeof(int) ||
+                entry.length > INT_MAX) {
+            release_datasets(store);
+            return binary_file_error(path, "dataset extends past end of file");
+        }
+
+        const int *data = reinterpret_cast<const int *>(base + entry.offset);
+
+        if ((header->flags & BINARY_FLAG_CHECKSUMS) &&
+                checksum_elements(data, entry.length) != entry.checksum) {
+            std::cerr << "ERROR: Checksum mismatch in dataset " << (i + 1)
+                << " of " << path << std::endl;
+            release_datasets(store);
+            return false;
+        }
+
+        store.views.push_back(DatasetView{data, (int) entry.length});
+    }
+
+    return true;
+}
+
+/*
+ * Write the given datasets to a binary dataset file at the given path, with
+ * a checksum for each. Return false, after notifying the user, if the file
+ * could not be written.
+ */
+bool write_binary_datasets (const std::vector<DatasetView>& datasets,
+    const char *path)
+{
+    std::FILE *file;                          /* The output file */
+    BinaryHeader header;                      /* Header of the output file */
+    std::vector<BinaryDatasetEntry> entries;  /* Directory of the output file */
+    std::uint64_t offset;                     /* Offset of the next dataset */
+    static const char padding[BINARY_ALIGNMENT] = {0};
+
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.element_type = BINARY_TYPE_INT32;
+    header.num_datasets = datasets.size();
+    header.flags = BINARY_FLAG_CHECKSUMS;
+
+    /* Lay out the datasets after the directory, each aligned */
+    offset = sizeof(BinaryHeader) + datasets.size() * sizeof(BinaryDatasetEntry);
+
+    for (std::size_t i = 0; i < datasets.size(); ++i) {
+        BinaryDatasetEntry entry;
+
+        offset = (offset + BINARY_ALIGNMENT - 1) / BINARY_ALIGNMENT * BINARY_ALIGNMENT;
+        entry.offset = offset;
+        entry.length = datasets[i].size;
+        entry.checksum = checksum_elements(datasets[i].data, datasets[i].size);
+        entries.push_back(entry);
+
+        offset += (std::uint64_t) datasets[i].size * sizeof(int);
+    }
+
+    file = std::fopen(path, "wb");
+    if (!file) {
+        std::cerr << "ERROR: Could not create output file " << path << ": "
+            << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    offset = sizeof(BinaryHeader) + entries.size() * sizeof(BinaryDatasetEntry);
+    std::fwrite(&header, sizeof(header), 1, file);
+    std::fwrite(entries.data(), sizeof(BinaryDatasetEntry), entries.size(), file);
+
+    for (std::size_t i = 0; i < datasets.size(); ++i) {
+        std::fwrite(padding, 1, entries[i].offset - offset, file);
+        std::fwrite(datasets[i].data, sizeof(int), datasets[i].size, file);
+        offset = entries[i].offset + (std::uint64_t) datasets[i].size * sizeof(int);
+    }
+
+    if (std::ferror(file) | std::fclose(file)) {
+        std::cerr << "ERROR: Could not write output file " << path << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Read the directory of the binary dataset file at the given path into
+ * entries without mapping the file, so that datasets too large to map or to
+ * index with an int can be streamed from it, and set checksummed if the
+ * entries carry checksums, which are left to the reader to verify. Return
+ * false, after notifying the user, if the file cannot be used.
+ */
+bool read_binary_directory (const char *path, std::vector<BinaryDatasetEntry>& entries,
+    bool& checksummed)
+{
+    int fd;                /* Descriptor of the input file */
+    struct stat info;      /* Size of the input file */
+    BinaryHeader header;   /* Header of the input file */
+    std::uint64_t length;  /* Length of the file in bytes */
+    bool complete;         /* Whether the header and directory could be read */
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &info) < 0) {
+        std::cerr << "ERROR: Could not open input file " << path << ": "
+            << std::strerror(errno) << std::endl;
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+
+    length = info.st_size;
+    complete = pread(fd, &header, sizeof(header), 0) == (ssize_t) sizeof(header) &&
+        !std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+
+    if (complete && header.version != BINARY_VERSION) {
+        close(fd);
+        return binary_file_error(path, "unsupported format version");
+    }
+
+    if (complete && header.element_type != BINARY_TYPE_INT32) {
+        close(fd);
+        return binary_file_error(path, "unsupported element type");
+    }
+
+    if (complete && header.num_datasets <= (length - sizeof(BinaryHeader)) /
+            sizeof(BinaryDatasetEntry)) {
+        const std::size_t bytes = header.num_datasets * sizeof(BinaryDatasetEntry);
+
+        entries.resize(header.num_datasets);
+        complete = pread(fd, entries.data(), bytes, sizeof(header)) == (ssize_t) bytes;
+    } else {
+        complete = false;
+    }
+
+    close(fd);
+
+    if (!complete)
+        return binary_file_error(path, "truncated header or dataset directory");
+
+    checksummed = (header.flags & BINARY_FLAG_CHECKSUMS) != 0;
+
+    for (std::size_t i = 0; i < entries.size(); ++i)
+        if (entries[i].offset % alignof(int) != 0 || entries[i].offset > length ||
+                entries[i].length > (length - entries[i].offset) / sizeof(int))
+            return binary_file_error(path, "dataset extends past end of file");
+
+    return true;
+}
+
+/*
+ * Return the 64-bit FNV-1a checksum of the n given elements, hashing one
+ * element at a time, continuing from the given hash of any elements before
+ * them.
+ */
+std::uint64_t checksum_elements (const int *data, std::size_t n, std::uint64_t hash)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        hash = (hash ^ (std::uint32_t) data[i]) * 0x100000001b3ULL;
+
+    return hash;
+}
+
+/*
+ * Read the lists of integers in the given file, or on stdin if path is NULL,
+ * into the specified list of datasets. If a token could not be parsed as an
+ * integer, the user is notified of the failure with its line and position,
+ * and the rest of the dataset is still parsed. Return false only if the
+ * input could not be read at all.
+ */
+bool read_in_datasets (DatasetList& datasets, const char *path)
+{
+    DatasetParser parser;  /* State of the parse across blocks of input */
+
+    parser.datasets = &datasets;
+    parser.linecount = 1;
+    parser.position = 1;
+    parser.at_line_start = true;
+    parser.done = false;
+    parser.errors_occured = false;
+
+    if (path) {
+        if (!read_in_mapped_file(parser, path))
+            return false;
+    } else {
+        read_in_stream(parser, stdin);
+    }
+
+    if (parser.errors_occured)
+        std::cerr << std::endl;
+
+    return true;
+}
+
+/*
+ * Parse the given stream in blocks of READ_BLOCK_SIZE bytes. A token cut off
+ * by the end of a block is carried over to the front of the buffer and
+ * completed by the next read.
+ */
+void read_in_stream (DatasetParser& parser, std::FILE *stream)
+{
+    std::vector<char> buffer(READ_BLOCK_SIZE);  /* Unparsed input */
+    std::size_t carry;                          /* Bytes carried from the last block */
+    std::size_t length;                         /* Bytes of input in the buffer */
+    std::size_t consumed;                       /* Bytes parsed from the buffer */
+    bool final;                                 /* Whether the input is exhausted */
+
+    carry = 0;
+    final = false;
+
+    while (!final && !parser.done) {
+        /* A single token filling the whole buffer needs more room */
+        if (carry == buffer.size())
+            buffer.resize(2 * buffer.size());
+
+        length = carry + std::fread(buffer.data() + carry, 1,
+            buffer.size() - carry, stream);
+        final = length < buffer.size();
+
+        consumed = parse_block(parser, buffer.data(), buffer.data() + length, final);
+
+        carry = length - consumed;
+        std::memmove(buffer.data(), buffer.data() + consumed, carry);
+    }
+}
+
+/*
+ * Parse the file at the given path by mapping it into memory in one piece.
+ * Return false, after notifying the user, if the file cannot be mapped.
+ */
+bool read_in_mapped_file (DatasetParser& parser, const char *path)
+{
+    int fd;              /* Descriptor of the input file */
+    struct stat info;    /* Size of the input file */
+    void *mapping;       /* Address of the mapped file */
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &info) < 0) {
+        std::cerr << "ERROR: Could not open input file " << path << ": "
+            << std::strerror(errno) << std::endl;
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+
+    if (info.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        std::cerr << "ERROR: Could not map input file " << path << ": "
+            << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+
+    const char *begin = static_cast<const char *>(mapping);
+    parse_block(parser, begin, begin + info.st_size, true);
+
+    munmap(mapping, info.st_size);
+    return true;
+}
+
+/*
+ * Parse the text in begin..end, appending the integers found to the current
+ * dataset and starting a new dataset at each line. Unless final is set, the
+ * text is assumed to continue past end, so parsing stops before any token or
+ * line ending that touches end. Return the number of bytes consumed.
+ */
+std::size_t parse_block (DatasetParser& parser, const char *begin,
+    const char *end, bool final)
+{
+    const char *p;  /* Next unparsed character */
+
+    p = begin;
+
+    while (p < end && !parser.done) {
+        if (parser.at_line_start) {
+            /* An empty line, or one holding nothing but blanks, ends the
+             * input. */
+            const char *q = p;
+
+            while (q < end && is_blank(*q))
+                ++q;
+
+            if (q == end && !final)
+                break;
+
+            if (q == end || *q == '\n') {
+                parser.done = true;
+                break;
+            }
+
+            parser.datasets->emplace_back();
+            parser.position = 1;
+            parser.at_line_start = false;
+        }
+
+        if (*p == '\n') {
+            ++parser.linecount;
+            parser.at_line_start = true;
+            ++p;
+            continue;
+        }
+
+        if (is_blank(*p)) {
+            ++p;
+            continue;
+        }
+
+        /* Scan one token, accumulating its value as long as it still looks
+         * like an integer that fits in an int. */
+        const char *q = p;
+        bool negative = false;
+        bool valid = true;
+        unsigned long long magnitude = 0;
+
+        if (*q == '-' || *q == '+') {
+            negative = (*q == '-');
+            ++q;
+        }
+
+        const char *digits = q;
+
+        while (q < end && *q != '\n' && !is_blank(*q)) {
+            unsigned digit = (unsigned char) *q - '0';
+
+            if (digit > 9 || magnitude > (unsigned long long) INT_MAX + 1)
+                valid = false;
+            else
+                magnitude = magnitude * 10 + digit;
+
+            ++q;
+        }
+
+        if (q == end && !final)
+            break;
+
+        if (q == digits || magnitude > (unsigned long long) INT_MAX + negative)
+            valid = false;
+
+        if (valid) {
+            parser.datasets->back().push_back(negative ?
+                (int) -(long long) magnitude : (int) magnitude);
+        } else {
+            parser.errors_occured = true;
+            std::cerr << "ERROR: Failed to convert element at line "
+                << parser.linecount << ", position " << parser.position
+                << " to an integer" << std::endl;
+        }
+
+        ++parser.position;
+        p = q;
+    }
+
+    return p - begin;
+}
@@ -0,0 +1,106 @@
+/**
+ * Loading of the input datasets. The text format has one dataset per line,
+ * each a whitespace-separated list of integers, and ends at the first blank
+ * line or at the end of the input. Input is read in large blocks from stdin,
+ * or memory-mapped when a file path is given, and integers are parsed by a
+ * hand-written scanner directly into the destination datasets.
+ *
+ * Datasets can also be stored in a compact binary format, which is mapped
+ * into memory and used in place without any parsing or copying. A binary
+ * file holds a BinaryHeader, then one BinaryDatasetEntry per dataset, then
+ * the elements of each dataset at the offset its entry gives, aligned to
+ * BINARY_ALIGNMENT bytes. All fields are in the byte order of the machine
+ * that wrote the file.
+ */
+
+#ifndef DATASETIO_H
+#define DATASETIO_H
+
+/* include statements */
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* using declarations */
+using DatasetList = std::vector< std::vector<int> >;
+
+/* A read-only view of the pristine elements of one dataset */
+struct DatasetView {
+    const int *data;
+    int size;
+};
+
+/* The storage behind a list of dataset views: either datasets parsed from
+ * text, or a mapped binary dataset file */
+struct DatasetStore {
+    DatasetList parsed;                /* Datasets parsed from text or generated */
+    void *mapping;                     /* Mapped binary file, or NULL */
+    std::size_t mapping_length;        /* Length of the mapping in bytes */
+    std::vector<DatasetView> views;    /* One view per dataset */
+    std::vector<std::string> labels;   /* Description of each generated dataset */
+};
+
+/* Header at the start of a binary dataset file */
+struct BinaryHeader {
+    char magic[8];               /* BINARY_MAGIC */
+    std::uint32_t version;       /* BINARY_VERSION */
+    std::uint32_t element_type;  /* One of the BINARY_TYPE_ values */
+    std::uint64_t num_datasets;  /* Number of directory entries that follow */
+    std::uint64_t flags;         /* Bitwise OR of the BINARY_FLAG_ values */
+};
+
+/* Directory entry describing one dataset in a binary dataset file */
+struct BinaryDatasetEntry {
+    std::uint64_t offset;    /* Byte offset of the first element in the file */
+    std::uint64_t length;    /* Number of elements */
+    std::uint64_t checksum;  /* checksum_elements() of the elements, if present */
+};
+
+/* State of the text parser, carried from one block of input to the next */
+struct DatasetParser {
+    DatasetList *datasets;  /* List the parsed datasets are appended to */
+    int linecount;          /* Line counter, for error reporting */
+    int position;           /* Position counter, for error reporting */
+    bool at_line_start;     /* Whether the next character begins a line */
+    bool done;              /* Whether the terminating empty line was seen */
+    bool errors_occured;    /* Whether any parse errors have occurred */
+};
+
+/* constants */
+const std::size_t READ_BLOCK_SIZE = 1 << 20;  /* Bytes requested from stdin per read */
+const char BINARY_MAGIC[8] = {'S', 'O', 'R', 'T', 'C', 'M', 'P', 'B'};
+const std::uint32_t BINARY_VERSION = 1;
+const std::uint32_t BINARY_TYPE_INT32 = 1;     /* Elements are 32-bit signed ints */
+const std::uint64_t BINARY_FLAG_CHECKSUMS = 1; /* Directory entries carry checksums */
+const std::size_t BINARY_ALIGNMENT = 64;       /* Alignment of each dataset's elements */
+const std::uint64_t CHECKSUM_SEED = 0xcbf29ce484222325ULL;  /* Checksum of no elements */
+
+/* function declarations */
+bool load_datasets (DatasetStore& store, const char *path);
+void release_datasets (DatasetStore& store);
+bool is_binary_dataset_file (const char *path);
+bool load_binary_datasets (DatasetStore& store, const char *path);
+bool write_binary_datasets (const std::vector<DatasetView>& datasets,
+    const char *path);
+bool read_binary_directory (const char *path, std::vector<BinaryDatasetEntry>& entries,
+    bool& checksummed);
+std::uint64_t checksum_elements (const int *data, std::size_t n,
+    std::uint64_t hash = CHECKSUM_SEED);
+bool read_in_datasets (DatasetList& datasets, const char *path);
+void read_in_stream (DatasetParser& parser, std::FILE *stream);
+bool read_in_mapped_file (DatasetParser& parser, const char *path);
+std::size_t parse_block (DatasetParser& parser, const char *begin,
+    const char *end, bool final);
+
+#endif // DATASETIO_H
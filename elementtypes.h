@@ -0,0 +1,139 @@
+/**
+ * The element types the sorting algorithms can be benchmarked on. Datasets
+ * are always read or generated as ints, and are converted to the selected
+ * element type outside the timed region: to int64_t, float or double by
+ * value, or to a 16-byte Record whose key is the value and whose payload is
+ * the element's original index, or to a 64-byte WideRecord, a cache line
+ * holding the same key and a payload of seven words, the first of them the
+ * original index. Since the original index travels with every record, the
+ * output of a record sort shows whether the algorithm is stable.
+ */
+
+#ifndef ELEMENTTYPES_H
+#define ELEMENTTYPES_H
+
+/* include statements */
+#include <cstdint>
+#include <vector>
+
+#include "datasetio.h"
+#include "opcount.h"
+
+/* A key with a payload, compared on the key alone */
+struct Record {
+    std::int64_t key;      /* Value the records are sorted by */
+    std::int64_t payload;  /* Data carried along with the key */
+};
+
+/* constants */
+const int WIDE_PAYLOAD_WORDS = 7;  /* Words of payload in a WideRecord */
+
+/* A key with a payload filling the rest of a cache line, compared on the
+ * key alone */
+struct WideRecord {
+    std::int64_t key;                          /* Value the records are sorted by */
+    std::int64_t payload[WIDE_PAYLOAD_WORDS];  /* Original index, then filler */
+};
+
+/* The element types that can be selected with --type */
+enum ElementType {
+    ELEMENT_INT,
+    ELEMENT_INT64,
+    ELEMENT_FLOAT,
+    ELEMENT_DOUBLE,
+    ELEMENT_RECORD,
+    ELEMENT_WIDE
+};
+
+/* Apply the given macro to the type benchmarked for every element type, for
+ * explicit instantiation */
+#define FOR_EACH_ELEMENT_TYPE(X) \
+    X(Benchmarked<int>) X(Benchmarked<std::int64_t>) X(Benchmarked<float>) \
+    X(Benchmarked<double>) X(Benchmarked<Record>) X(Benchmarked<WideRecord>)
+
+/*
+ * Return whether record a has a smaller key than record b.
+ */
+inline bool operator< (const Record& a, const Record& b)
+{
+    return a.key < b.key;
+}
+
+/*
+ * Return whether wide record a has a smaller key than wide record b.
+ */
+inline bool operator< (const WideRecord& a, const WideRecord& b)
+{
+    return a.key < b.key;
+}
+
+/*
+ * Return the element of type T representing the given input value, found
+ * at the given index of its dataset.
+ */
+template <typename T>
+inline T make_element (int value, int index)
+{
+    (void) index;
+    return (T) value;
+}
+
+template <>
+inline Record make_element<Record> (int value, int index)
+{
+    return Record{value, index};
+}
+
+template <>
+inline WideRecord make_element<WideRecord> (int value, int index)
+{
+    WideRecord x;  /* The new record */
+
+    x.key = value;
+    for (int w = 0; w < WIDE_PAYLOAD_WORDS; ++w)
+        x.payload[w] = (std::int64_t) index << w;
+
+    return x;
+}
+
+/*
+ * Convert the given dataset into elements of type T held in buffer, and
+ * return a pointer to them.
+ */
+template <typename T>
+const T *convert_dataset (const DatasetView& dataset, std::vector<T>& buffer)
+{
+    buffer.resize(dataset.size);
+
+    for (int i = 0; i < dataset.size; ++i)
+        buffer[i] = make_element<T>(dataset.data[i], i);
+
+    return buffer.data();
+}
+
+/*
+ * Convert the given dataset into counted elements of type T held in buffer,
+ * and return a pointer to them.
+ */
+template <typename T>
+const Counted<T> *convert_dataset (const DatasetView& dataset,
+    std::vector<Counted<T> >& buffer)
+{
+    buffer.resize(dataset.size);
+
+    for (int i = 0; i < dataset.size; ++i)
+        buffer[i] = Counted<T>(make_element<T>(dataset.data[i], i));
+
+    return buffer.data();
+}
+
+/*
+ * Return the given dataset's own ints, which need no conversion.
+ */
+inline const int *convert_dataset (const DatasetView& dataset, std::vector<int>& buffer)
+{
+    (void) buffer;
+    return dataset.data;
+}
+
+#endif // ELEMENTTYPES_H
@@ -0,0 +1,508 @@
+/**
+ * External-memory sorting, for datasets larger than the memory the sort may
+ * use. With --external ALGO, each dataset of a binary input file is sorted
+ * in two phases that are timed separately. Run generation reads the dataset
+ * in chunks that fill half of the memory budget, sorts each chunk with the
+ * registered algorithm ALGO, and spills it to a temporary file as a sorted
+ * run, reading the next chunk while the current one is sorted. The merge
+ * phase then merges the runs with a loser tree, which finds the smallest
+ * head of k runs in log2(k) comparisons, each run read, and the output
+ * written, in large blocks with two buffers apiece, so that the next block
+ * of every stream is read or written in the background while the current
+ * one is in use. When there are more runs than the memory budget can give
+ * blocks of a useful size, they are merged in several passes.
+ *
+ * Datasets are streamed from the file rather than mapped, so they can be
+ * larger than memory and longer than an int can count. The input's checksum
+ * is verified as it is read, and the output is checked to be sorted as it
+ * is written. Temporary files are unlinked as soon as they are created, so
+ * nothing is left behind even if the program is interrupted.
+ */
+
+#include "externalsort.h"
+
+/*
+ * Sort the dataset described by the given directory entry of the binary
+ * dataset file at the given path, outside of memory, with the given
+ * algorithm sorting each chunk, verifying the entry's checksum if the file
+ * is checksummed, and fill result with what was done and how long each
+ * phase took. The sorted output is written to a temporary file and
+ * discarded. Return false, after notifying the user, if a file could not be
+ * read or written.
+ */
+bool external_sort_dataset (const char *path, const BinaryDatasetEntry& entry,
+    bool checksummed, SortAlgo<int> sort, const ExternalOptions& options,
+    ExternalResult& result)
+{
+    int input_fd;                    /* The input file */
+    int temp_fds[2];                 /* Temporary files merge passes alternate between */
+    std::vector<SpilledRun> runs;    /* Runs awaiting merging */
+    std::vector<SpilledRun> merged;  /* Runs written by the current pass */
+    bool ok;                         /* Whether every phase succeeded */
+    long long chunk_length;          /* Elements per chunk of run generation */
+
+    result = ExternalResult{(long long) entry.length, 0, 0, 0, 0, 0, 0, 0, 0, true, true};
+
+    /* Run generation holds the chunk being sorted and the next one, and a
+     * chunk is sorted by a single call, so its length must fit in an int */
+    chunk_length = std::max(options.memory_bytes / 2 / (long long) sizeof(int), 1LL);
+    chunk_length = std::min(chunk_length, (long long) INT_MAX);
+
+    input_fd = open(path, O_RDONLY);
+    if (input_fd < 0) {
+        std::cerr << "ERROR: Could not open input file " << path << ": "
+            << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    temp_fds[0] = create_temp_file(options.temp_dir);
+    temp_fds[1] = create_temp_file(options.temp_dir);
+    ok = temp_fds[0] >= 0 && temp_fds[1] >= 0;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(input_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    Clock::time_point start = Clock::now();
+
+    if (ok)
+        ok = generate_runs(input_fd, entry, sort, chunk_length, temp_fds[0], runs, result);
+
+    if (!checksummed)
+        result.checksum_ok = true;
+
+    Clock::time_point middle = Clock::now();
+
+    /* Each pass merges the runs in one temporary file into fewer runs in
+     * the other, until there is only one */
+    for (int pass = 0; ok && runs.size() > 1; ++pass) {
+        const int in = pass % 2;
+        const int blocks = options.memory_bytes / EXTERNAL_MIN_BLOCK_BYTES / 2;
+        const int fan_in = std::max(2, std::min(EXTERNAL_MAX_FAN_IN, blocks - 1));
+
+        ok = ftruncate(temp_fds[1 - in], 0) == 0 && merge_runs_pass(temp_fds[in], runs,
+            fan_in, options.memory_bytes, temp_fds[1 - in], merged, result);
+        runs.swap(merged);
+        ++result.merge_passes;
+    }
+
+    Clock::time_point end = Clock::now();
+
+    result.run_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        middle - start).count();
+    result.merge_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end - middle).count();
+
+    close(input_fd);
+    for (int i = 0; i < 2; ++i)
+        if (temp_fds[i] >= 0)
+            close(temp_fds[i]);
+
+    return ok;
+}
+
+/*
+ * Read the dataset described by the given directory entry from the input
+ * file in chunks of chunk_length elements, sort each with the given
+ * algorithm, and append it to the spill file as a sorted run, appending the
+ * runs to runs. The next chunk is read, and the previous run written, while
+ * each chunk is sorted. Return false, after notifying the user, on an
+ * input or output error.
+ */
+bool generate_runs (int input_fd, const BinaryDatasetEntry& entry, SortAlgo<int> sort,
+    long long chunk_length, int spill_fd, std::vector<SpilledRun>& runs,
+    ExternalResult& result)
+{
+    std::vector<int> chunks[2];            /* Chunk being sorted and chunk being read */
+    std::future<long long> pending_read;   /* Read of the next chunk */
+    std::future<bool> pending_write;       /* Write of the previous run */
+    std::uint64_t checksum = CHECKSUM_SEED;  /* Checksum of the input read so far */
+    long long read_length = 0;             /* Elements requested so far */
+    off_t spill_offset = 0;                /* Offset of the next run in the spill file */
+    bool ok = true;                        /* Whether every read and write succeeded */
+
+    chunk_length = std::min(chunk_length, std::max((long long) entry.length, 1LL));
+    result.run_length = chunk_length;
+
+    /* Start reading the chunk of elements following those requested so far
+     * into the given buffer */
+    auto request_chunk = [&] (std::vector<int>& chunk) {
+        const long long length = std::min(chunk_length,
+            (long long) entry.length - read_length);
+        const off_t offset = entry.offset + read_length * sizeof(int);
+
+        chunk.resize(chunk_length);
+        read_length += length;
+        return std::async(std::launch::async, read_fully, input_fd, chunk.data(),
+            length * (long long) sizeof(int), offset);
+    };
+
+    runs.clear();
+
+    if (entry.length > 0)
+        pending_read = request_chunk(chunks[0]);
+
+    for (int r = 0; pending_read.valid(); ++r) {
+        std::vector<int>& chunk = chunks[r % 2];
+        long long bytes = pending_read.get();
+
+        if (bytes < 0 || bytes % sizeof(int) != 0) {
+            ok = false;
+            break;
+        }
+
+        const int length = bytes / sizeof(int);
+
+        /* The write of the previous run must finish before its buffer is
+         * refilled */
+        if (pending_write.valid() && !pending_write.get())
+            ok = false;
+
+        if (read_length < (long long) entry.length)
+            pending_read = request_chunk(chunks[(r + 1) % 2]);
+
+        checksum = checksum_elements(chunk.data(), length, checksum);
+
+        Clock::time_point start = Clock::now();
+        sort(chunk.data(), length);
+        result.sort_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - start).count();
+
+        /* A single run is the output, which must be sorted */
+        if (entry.length == (unsigned long long) length)
+            result.sorted = std::is_sorted(chunk.begin(), chunk.begin() + length);
+
+        runs.push_back(SpilledRun{spill_offset, length});
+        pending_write = std::async(std::launch::async, write_fully, spill_fd, chunk.data(),
+            (long long) length * sizeof(int), spill_offset);
+        spill_offset += (off_t) length * sizeof(int);
+        result.bytes_written += (long long) length * sizeof(int);
+    }
+
+    if (pending_read.valid())
+        pending_read.wait();
+
+    if (pending_write.valid() && !pending_write.get())
+        ok = false;
+
+    if (!ok) {
+        std::cerr << "ERROR: Could not read the input or write a run: "
+            << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    result.runs = runs.size();
+    result.checksum_ok = checksum == entry.checksum;
+
+    return true;
+}
+
+/*
+ * Merge each group of fan_in consecutive runs of the given file into one
+ * run of the output file, appending the merged runs to merged, and giving
+ * every run of a group a block of the memory budget for each of its two
+ * buffers. The output is checked to be sorted when it is the final run.
+ * Return false, after notifying the user, on an input or output error.
+ */
+bool merge_runs_pass (int input_fd, const std::vector<SpilledRun>& runs, int fan_in,
+    long long memory_bytes, int output_fd, std::vector<SpilledRun>& merged,
+    ExternalResult& result)
+{
+    BlockWriter writer;   /* The output of the pass */
+    bool sorted = true;   /* Whether every merged run came out sorted */
+    bool ok = true;       /* Whether every group was merged */
+    int k;                /* Runs in the current group */
+    long long block_bytes;  /* Bytes per block of each stream */
+
+    k = std::min<int>(fan_in, runs.size());
+    block_bytes = memory_bytes / (2 * (k + 1));
+    block_bytes = std::max(EXTERNAL_MIN_BLOCK_BYTES, std::min(EXTERNAL_MAX_BLOCK_BYTES,
+        block_bytes));
+    result.fan_in = std::max(result.fan_in, k);
+
+    merged.clear();
+    start_block_writer(writer, output_fd, 0, block_bytes / sizeof(int));
+
+    for (std::size_t g = 0; ok && g < runs.size(); g += fan_in) {
+        const int group = std::min<int>(fan_in, runs.size() - g);
+        SpilledRun run = SpilledRun{writer.offset + (off_t) (writer.count * sizeof(int)), 0};
+
+        for (int i = 0; i < group; ++i)
+            run.length += runs[g + i].length;
+
+        ok = merge_run_group(input_fd, runs.data() + g, group, block_bytes / sizeof(int),
+            writer, sorted);
+        merged.push_back(run);
+    }
+
+    ok = finish_block_writer(writer) && ok;
+    result.bytes_written += writer.offset;
+
+    if (merged.size() == 1)
+        result.sorted = sorted;
+
+    if (!ok)
+        std::cerr << "ERROR: Could not merge runs: " << std::strerror(errno) << std::endl;
+
+    return ok;
+}
+
+/*
+ * Merge the k given runs of the input file onto the given writer, reading
+ * each in blocks of block_length elements, and clear sorted if the output
+ * is ever out of order. The runs compete in a loser tree, whose internal
+ * nodes each hold the run that lost the match played there, so that after
+ * the winner's next element replaces it, only the matches on the path from
+ * its leaf to the root are replayed. Return false if a read failed.
+ */
+bool merge_run_group (int input_fd, const SpilledRun *runs, int k, int block_length,
+    BlockWriter& writer, bool& sorted)
+{
+    std::vector<BlockReader> readers(k);  /* One stream per run */
+    std::vector<int> heads(k);            /* Current element of each run */
+    std::vector<char> live(k);            /* Whether each run has elements left */
+    std::vector<int> losers(k);           /* Loser of the match at each internal node */
+    std::vector<int> winners(2 * k);      /* Winners of the initial matches */
+    bool ok = true;                       /* Whether every read succeeded */
+    int winner;                           /* Run holding the smallest head */
+    int last = 0;                         /* Last element output */
+    bool any = false;                     /* Whether any element was output */
+
+    /* Whether run a's head comes out before run b's */
+    auto beats = [&] (int a, int b) {
+        return live[a] && (!live[b] || heads[a] < heads[b]);
+    };
+
+    for (int i = 0; i < k; ++i) {
+        start_block_reader(readers[i], input_fd, runs[i].offset, runs[i].length,
+            block_length);
+        live[i] = advance_block_reader(readers[i]);
+        if (live[i])
+            heads[i] = readers[i].buffers[readers[i].current][readers[i].position++];
+        winners[k + i] = i;
+    }
+
+    /* Play the initial matches from the leaves up */
+    for (int node = k - 1; node > 0; --node) {
+        const int a = winners[2 * node];
+        const int b = winners[2 * node + 1];
+
+        winners[node] = beats(a, b) ? a : b;
+        losers[node] = beats(a, b) ? b : a;
+    }
+
+    winner = k > 1 ? winners[1] : 0;
+
+    while (live[winner]) {
+        BlockReader& reader = readers[winner];
+
+        if (any && heads[winner] < last)
+            sorted = false;
+
+        last = heads[winner];
+        any = true;
+        writer.buffers[writer.current][writer.count++] = last;
+        if (writer.count == (int) writer.buffers[writer.current].size())
+            flush_block_writer(writer);
+
+        if (reader.position == reader.count && !advance_block_reader(reader))
+            live[winner] = false;
+        else
+            heads[winner] = reader.buffers[reader.current][reader.position++];
+
+        /* Replay the winner's path, leaving each match's loser behind */
+        for (int node = (winner + k) / 2; node > 0; node /= 2)
+            if (beats(losers[node], winner))
+                std::swap(losers[node], winner);
+    }
+
+    for (int i = 0; i < k; ++i) {
+        if (readers[i].pending.valid())
+            readers[i].pending.wait();
+        ok = ok && !readers[i].failed;
+    }
+
+    return ok;
+}
+
+/*
+ * Prepare the given reader to stream the given number of elements of the
+ * given file from the given offset, in blocks of block_length elements, and
+ * start reading the first block. advance_block_reader() makes it available.
+ */
+void start_block_reader (BlockReader& reader, int fd, off_t offset, long long length,
+    int block_length)
+{
+    reader.fd = fd;
+    reader.offset = offset;
+    reader.remaining = length;
+    reader.block_length = block_length;
+    reader.current = 0;
+    reader.count = reader.position = 0;
+    reader.failed = false;
+
+    for (int i = 0; i < 2; ++i)
+        reader.buffers[i].resize(std::min<long long>(block_length, std::max(length, 1LL)));
+
+    advance_block_reader(reader);
+
+    /* No block is in use yet, so the first one read is still to come */
+    reader.count = reader.position = 0;
+}
+
+/*
+ * Wait for the block being read by the given reader and make it the block
+ * in use, and start reading the block after it into the other buffer.
+ * Return whether the new block holds any elements.
+ */
+bool advance_block_reader (BlockReader& reader)
+{
+    reader.count = reader.position = 0;
+
+    if (reader.pending.valid()) {
+        long long bytes = reader.pending.get();
+
+        if (bytes < 0) {
+            reader.failed = true;
+            return false;
+        }
+
+        reader.current = 1 - reader.current;
+        reader.count = bytes / sizeof(int);
+    }
+
+    if (reader.remaining > 0) {
+        const long long length = std::min<long long>(reader.block_length, reader.remaining);
+
+        reader.pending = std::async(std::launch::async, read_fully, reader.fd,
+            reader.buffers[1 - reader.current].data(), length * (long long) sizeof(int),
+            reader.offset);
+        reader.offset += length * sizeof(int);
+        reader.remaining -= length;
+    }
+
+    return reader.count > 0;
+}
+
+/*
+ * Prepare the given writer to stream elements to the given file from the
+ * given offset, in blocks of block_length elements.
+ */
+void start_block_writer (BlockWriter& writer, int fd, off_t offset, int block_length)
+{
+    writer.fd = fd;
+    writer.offset = offset;
+    writer.current = 0;
+    writer.count = 0;
+    writer.failed = false;
+
+    for (int i = 0; i < 2; ++i)
+        writer.buffers[i].resize(block_length);
+}
+
+/*
+ * Start writing the block the given writer has filled, once its previous
+ * block is written, and begin filling the other buffer.
+ */
+void flush_block_writer (BlockWriter& writer)
+{
+    if (writer.pending.valid() && !writer.pending.get())
+        writer.failed = true;
+
+    if (writer.count == 0)
+        return;
+
+    writer.pending = std::async(std::launch::async, write_fully, writer.fd,
+        writer.buffers[writer.current].data(), (long long) writer.count * sizeof(int),
+        writer.offset);
+    writer.offset += (off_t) writer.count * sizeof(int);
+    writer.current = 1 - writer.current;
+    writer.count = 0;
+}
+
+/*
+ * Write out whatever the given writer holds and wait for every write to
+ * complete. Return whether every write succeeded.
+ */
+bool finish_block_writer (BlockWriter& writer)
+{
+    flush_block_writer(writer);
+
+    if (writer.pending.valid() && !writer.pending.get())
+        writer.failed = true;
+
+    return !writer.failed;
+}
+
+/*
+ * Read up to the given number of bytes of the given file from the given
+ * offset into buffer, retrying short reads. Return the number of bytes
+ * read, which is less only at the end of the file, or -1 on an error.
+ */
+long long read_fully (int fd, void *buffer, long long bytes, off_t offset)
+{
+    long long done = 0;  /* Bytes read so far */
+
+    while (done < bytes) {
+        ssize_t got = pread(fd, static_cast<char *>(buffer) + done, bytes - done,
+            offset + done);
+
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+            return -1;
+        if (got == 0)
+            break;
+
+        done += got;
+    }
+
+    return done;
+}
+
+/*
+ * Write the given number of bytes from buffer to the given file at the
+ * given offset, retrying short writes. Return whether all were written.
+ */
+bool write_fully (int fd, const void *buffer, long long bytes, off_t offset)
+{
+    long long done = 0;  /* Bytes written so far */
+
+    while (done < bytes) {
+        ssize_t put = pwrite(fd, static_cast<const char *>(buffer) + done, bytes - done,
+            offset + done);
+
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put <= 0)
+            return false;
+
+        done += put;
+    }
+
+    return true;
+}
+
+/*
+ * Create and immediately unlink a temporary file in the given directory,
+ * returning its descriptor, or -1, after notifying the user, if it could
+ * not be created.
+ */
+int create_temp_file (const char *dir)
+{
+    std::string path = std::string(dir) + "/sortcomparer-XXXXXX";
+    std::vector<char> name(path.begin(), path.end());
+    int fd;  /* Descriptor of the new file */
+
+    name.push_back('\0');
+    fd = mkstemp(name.data());
+
+    if (fd < 0) {
+        std::cerr << "ERROR: Could not create a temporary file in " << dir << ": "
+            << std::strerror(errno) << std::endl;
+        return -1;
+    }
+
+    unlink(name.data());
+    return fd;
+}
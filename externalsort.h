@@ -0,0 +1,125 @@
+/**
+ * External-memory sorting, for datasets larger than the memory the sort may
+ * use. With --external ALGO, each dataset of a binary input file is sorted
+ * in two phases that are timed separately. Run generation reads the dataset
+ * in chunks that fill half of the memory budget, sorts each chunk with the
+ * registered algorithm ALGO, and spills it to a temporary file as a sorted
+ * run, reading the next chunk while the current one is sorted. The merge
+ * phase then merges the runs with a loser tree, which finds the smallest
+ * head of k runs in log2(k) comparisons, each run read, and the output
+ * written, in large blocks with two buffers apiece, so that the next block
+ * of every stream is read or written in the background while the current
+ * one is in use. When there are more runs than the memory budget can give
+ * blocks of a useful size, they are merged in several passes.
+ *
+ * Datasets are streamed from the file rather than mapped, so they can be
+ * larger than memory and longer than an int can count. The input's checksum
+ * is verified as it is read, and the output is checked to be sorted as it
+ * is written. Temporary files are unlinked as soon as they are created, so
+ * nothing is left behind even if the program is interrupted.
+ */
+
+#ifndef EXTERNALSORT_H
+#define EXTERNALSORT_H
+
+/* include statements */
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "benchmark.h"
+#include "datasetio.h"
+
+/* Settings of an external sort */
+struct ExternalOptions {
+    const char *algo;        /* Name of the algorithm sorting each chunk, or NULL */
+    long long memory_bytes;  /* Memory the chunks and I/O buffers may use */
+    const char *temp_dir;    /* Directory for the temporary files */
+};
+
+/* A sorted run in a temporary file */
+struct SpilledRun {
+    off_t offset;            /* Byte offset of the run's first element */
+    long long length;        /* Number of elements in the run */
+};
+
+/* A sequential stream of elements from a file, read one block ahead */
+struct BlockReader {
+    int fd;                       /* File being read */
+    off_t offset;                 /* Offset of the next block to request */
+    long long remaining;          /* Elements not yet requested */
+    int block_length;             /* Elements per block */
+    std::vector<int> buffers[2];  /* Block in use and block being read */
+    int current;                  /* Index of the buffer in use */
+    int count;                    /* Elements in the buffer in use */
+    int position;                 /* Next element of the buffer in use */
+    std::future<long long> pending;  /* Read of the other buffer, if valid */
+    bool failed;                  /* Whether a read failed */
+};
+
+/* A sequential stream of elements to a file, written one block behind */
+struct BlockWriter {
+    int fd;                       /* File being written */
+    off_t offset;                 /* Offset of the next block to write */
+    std::vector<int> buffers[2];  /* Block being filled and block being written */
+    int current;                  /* Index of the buffer being filled */
+    int count;                    /* Elements in the buffer being filled */
+    std::future<bool> pending;    /* Write of the other buffer, if valid */
+    bool failed;                  /* Whether a write failed */
+};
+
+/* What an external sort of one dataset did and how long it took */
+struct ExternalResult {
+    long long length;        /* Number of elements sorted */
+    int runs;                /* Sorted runs spilled by run generation */
+    long long run_length;    /* Elements per run, the last possibly fewer */
+    int merge_passes;        /* Passes over the data made by the merge phase */
+    int fan_in;              /* Most runs merged at once */
+    long long run_ns;        /* Time spent generating runs */
+    long long sort_ns;       /* Time of run generation spent sorting chunks */
+    long long merge_ns;      /* Time spent merging runs */
+    long long bytes_written; /* Bytes written to temporary files */
+    bool checksum_ok;        /* Whether the input matched its checksum */
+    bool sorted;             /* Whether the output was found sorted */
+};
+
+/* constants */
+const long long DEFAULT_EXTERNAL_MEMORY_MB = 256;      /* Default memory budget */
+const long long EXTERNAL_MIN_BLOCK_BYTES = 1 << 16;    /* Smallest block worth reading */
+const long long EXTERNAL_MAX_BLOCK_BYTES = 1 << 22;    /* Largest block read or written */
+const int EXTERNAL_MAX_FAN_IN = 512;                   /* Most runs merged at once */
+
+/* function declarations */
+bool external_sort_dataset (const char *path, const BinaryDatasetEntry& entry,
+    bool checksummed, SortAlgo<int> sort, const ExternalOptions& options,
+    ExternalResult& result);
+bool generate_runs (int input_fd, const BinaryDatasetEntry& entry, SortAlgo<int> sort,
+    long long chunk_length, int spill_fd, std::vector<SpilledRun>& runs,
+    ExternalResult& result);
+bool merge_runs_pass (int input_fd, const std::vector<SpilledRun>& runs, int fan_in,
+    long long memory_bytes, int output_fd, std::vector<SpilledRun>& merged,
+    ExternalResult& result);
+bool merge_run_group (int input_fd, const SpilledRun *runs, int k, int block_length,
+    BlockWriter& writer, bool& sorted);
+void start_block_reader (BlockReader& reader, int fd, off_t offset, long long length,
+    int block_length);
+bool advance_block_reader (BlockReader& reader);
+void start_block_writer (BlockWriter& writer, int fd, off_t offset, int block_length);
+void flush_block_writer (BlockWriter& writer);
+bool finish_block_writer (BlockWriter& writer);
+long long read_fully (int fd, void *buffer, long long bytes, off_t offset);
+bool write_fully (int fd, const void *buffer, long long bytes, off_t offset);
+int create_temp_file (const char *dir);
+
+#endif // EXTERNALSORT_H
@@ -0,0 +1,244 @@
+/**
+ * Synthetic workload generation. Each dataset is described by a spec of the
+ * form "shape:key=value,key=value,...", for example
+ * "nearly_sorted:n=10M,swaps=1000", and is generated in parallel on the
+ * shared thread pool. Random values come from a counter-based splitmix64
+ * generator, so element i of a dataset depends only on the seed and i, and
+ * the output is identical whatever the number of threads.
+ */
+
+#include "sortcomparer.h"
+
+/*
+ * Return a uniformly distributed value below the given bound, which must be
+ * at most 2^32, from the given random bits.
+ */
+static inline std::uint64_t bounded (std::uint64_t bits, std::uint64_t bound)
+{
+    return ((bits >> 32) * bound) >> 32;
+}
+
+/*
+ * Generate one dataset for each of the given specs into the given store,
+ * pointing one view at each and labelling it with its spec. Return false,
+ * after notifying the user, if any spec is invalid.
+ */
+bool generate_datasets (DatasetStore& store, const std::vector<const char *>& specs)
+{
+    GeneratorSpec spec;  /* Parameters of the current dataset */
+
+    store.mapping = NULL;
+    store.mapping_length = 0;
+    store.parsed.clear();
+    store.parsed.reserve(specs.size());
+    store.labels.clear();
+
+    for (std::size_t i = 0; i < specs.size(); ++i) {
+        if (!parse_generator_spec(specs[i], i + 1, spec))
+            return false;
+
+        store.parsed.emplace_back();
+        generate_dataset(spec, store.parsed.back());
+        store.labels.push_back(specs[i]);
+    }
+
+    store.views.clear();
+    for (std::size_t i = 0; i < store.parsed.size(); ++i)
+        store.views.push_back(DatasetView{store.parsed[i].data(),
+            (int) store.parsed[i].size()});
+
+    return true;
+}
+
+/*
+ * Parse the given spec text into spec, filling in the default of every
+ * parameter not given. The default seed is the position of the spec on the
+ * command line, so repeated specs still produce different datasets. Return
+ * false, after notifying the user, if the spec is invalid.
+ */
+bool parse_generator_spec (const char *text, int index, GeneratorSpec& spec)
+{
+    static const char *shapes[] = {"uniform", "sorted", "reverse", "nearly_sorted",
+        "organ_pipe", "few_unique", "zipf", "sawtooth"};
+
+    std::string str(text);
+    std::size_t colon = str.find(':');
+    bool known = false;
+
+    spec.shape = str.substr(0, colon);
+    spec.n = 1000000;
+    spec.seed = index;
+    spec.range = 0;
+    spec.swaps = -1;
+    spec.unique = 16;
+    spec.zipf_s = 1.0;
+    spec.universe = -1;
+    spec.teeth = 16;
+
+    for (std::size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); ++i)
+        known = known || spec.shape == shapes[i];
+
+    if (!known) {
+        std::cerr << "ERROR: Unknown dataset shape '" << spec.shape
+            << "' in spec '" << text << "'" << std::endl;
+        return false;
+    }
+
+    /* Parse each key=value pair after the colon */
+    std::size_t pos = (colon == std::string::npos) ? str.size() : colon + 1;
+
+    while (pos < str.size()) {
+        std::size_t comma = str.find(',', pos);
+        if (comma == std::string::npos)
+            comma = str.size();
+
+        std::string pair = str.substr(pos, comma - pos);
+        std::size_t equals = pair.find('=');
+        std::string key = pair.substr(0, equals);
+        std::string value = (equals == std::string::npos) ? "" : pair.substr(equals + 1);
+        long long number = 0;
+        bool valid;
+
+        if (key == "s") {
+            char *end;
+            spec.zipf_s = std::strtod(value.c_str(), &end);
+            valid = !value.empty() && *end == '\0' && spec.zipf_s >= 0;
+        } else {
+            valid = parse_number(value.c_str(), number) && number >= 0;
+
+            if (key == "n")
+                spec.n = number;
+            else if (key == "seed")
+                spec.seed = number;
+            else if (key == "range")
+                spec.range = number;
+            else if (key == "swaps")
+                spec.swaps = number;
+            else if (key == "unique")
+                spec.unique = number;
+            else if (key == "universe")
+                spec.universe = number;
+            else if (key == "teeth")
+                spec.teeth = number;
+            else
+                valid = false;
+        }
+
+        if (!valid) {
+            std::cerr << "ERROR: Invalid parameter '" << pair << "' in spec '"
+                << text << "'" << std::endl;
+            return false;
+        }
+
+        pos = comma + 1;
+    }
+
+    if (spec.n > INT_MAX || spec.range > (1LL << 31) || spec.unique < 1 ||
+            spec.unique > (1LL << 31) || spec.teeth < 1 || spec.universe == 0 ||
+            spec.universe > INT_MAX) {
+        std::cerr << "ERROR: Parameter out of range in spec '" << text << "'"
+            << std::endl;
+        return false;
+    }
+
+    if (spec.swaps < 0)
+        spec.swaps = spec.n / 100;
+    if (spec.universe < 0)
+        spec.universe = std::max(1LL, std::min(spec.n, 1000000LL));
+
+    return true;
+}
+
+/*
+ * Fill the given dataset according to the given spec. Every shape is
+ * generated element by element in parallel, except for the swaps of a
+ * nearly sorted dataset, which are applied afterwards in order.
+ */
+void generate_dataset (const GeneratorSpec& spec, std::vector<int>& dataset)
+{
+    const int n = spec.n;
+    const std::uint64_t seed = random_at(spec.seed, 0);
+    std::vector<double> cdf;  /* Cumulative probabilities of the Zipf values */
+    int *v;                   /* Elements of the dataset */
+
+    dataset.resize(n);
+    v = dataset.data();
+
+    if (spec.shape == "uniform") {
+        const long long range = spec.range;
+
+        parallel_for(n, GENERATOR_GRAIN, [=] (int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                std::uint64_t bits = random_at(seed, i);
+                v[i] = range ? (int) bounded(bits, range) : (int) (bits >> 32);
+            }
+        });
+    } else if (spec.shape == "sorted" || spec.shape == "nearly_sorted") {
+        parallel_for(n, GENERATOR_GRAIN, [=] (int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                v[i] = i;
+        });
+
+        if (spec.shape == "nearly_sorted" && n > 1)
+            for (long long k = 0; k < spec.swaps; ++k)
+                std::swap(v[bounded(random_at(~seed, 2 * k), n)],
+                    v[bounded(random_at(~seed, 2 * k + 1), n)]);
+    } else if (spec.shape == "reverse") {
+        parallel_for(n, GENERATOR_GRAIN, [=] (int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                v[i] = n - 1 - i;
+        });
+    } else if (spec.shape == "organ_pipe") {
+        parallel_for(n, GENERATOR_GRAIN, [=] (int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                v[i] = std::min(i, n - 1 - i);
+        });
+    } else if (spec.shape == "few_unique") {
+        const long long unique = spec.unique;
+
+        parallel_for(n, GENERATOR_GRAIN, [=] (int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                v[i] = (int) bounded(random_at(seed, i), unique);
+        });
+    } else if (spec.shape == "zipf") {
+        /* Sample by inverting the cumulative distribution with a binary
+         * search, which keeps each element independent of the others. */
+        double total = 0;
+
+        cdf.resize(spec.universe);
+        for (long long k = 0; k < spec.universe; ++k) {
+            total += 1 / std::pow((double) (k + 1), spec.zipf_s);
+            cdf[k] = total;
+        }
+
+        const double *table = cdf.data();
+        const long long universe = spec.universe;
+
+        parallel_for(n, GENERATOR_GRAIN, [=] (int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                double u = (random_at(seed, i) >> 11) * (1.0 / 9007199254740992.0) * total;
+                v[i] = (int) (std::upper_bound(table, table + universe - 1, u) - table) + 1;
+            }
+        });
+    } else if (spec.shape == "sawtooth") {
+        const long long tooth = std::max(1LL, (spec.n + spec.teeth - 1) / spec.teeth);
+
+        parallel_for(n, GENERATOR_GRAIN, [=] (int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                v[i] = (int) (i % tooth);
+        });
+    }
+}
+
+/*
+ * Return the 64 random bits at the given position of the splitmix64 sequence
+ * with the given seed.
+ */
+std::uint64_t random_at (std::uint64_t seed, std::uint64_t index)
+{
+    std::uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,55 @@
+/**
+ * Synthetic workload generation. Each dataset is described by a spec of the
+ * form "shape:key=value,key=value,...", for example
+ * "nearly_sorted:n=10M,swaps=1000", and is generated in parallel on the
+ * shared thread pool. Random values come from a counter-based splitmix64
+ * generator, so element i of a dataset depends only on the seed and i, and
+ * the output is identical whatever the number of threads.
+ *
+ * Shapes and the keys they accept, besides n (length, default 1M) and seed:
+ *   uniform        range=R: values drawn uniformly from 0..R - 1 (default:
+ *                  the whole int range)
+ *   sorted         0, 1, 2, ..., n - 1
+ *   reverse        n - 1, n - 2, ..., 0
+ *   nearly_sorted  swaps=K: sorted, then K random pairs swapped (default n/100)
+ *   organ_pipe     ascending to the middle, then descending
+ *   few_unique     unique=K: values drawn uniformly from 0..K - 1 (default 16)
+ *   zipf           s=S, universe=U: values 1..U with probability proportional
+ *                  to 1/k^S (default S = 1, U = min(n, 1M))
+ *   sawtooth       teeth=K: K ascending runs of equal length (default 16)
+ */
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+/* include statements */
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "datasetio.h"
+
+/* The parameters of one generated dataset */
+struct GeneratorSpec {
+    std::string shape;     /* Name of the shape to generate */
+    long long n;           /* Number of elements */
+    std::uint64_t seed;    /* Seed of the random values */
+    long long range;       /* uniform: number of distinct values, or 0 for all */
+    long long swaps;       /* nearly_sorted: number of random swaps */
+    long long unique;      /* few_unique: number of distinct values */
+    double zipf_s;         /* zipf: exponent of the distribution */
+    long long universe;    /* zipf: number of distinct values */
+    long long teeth;       /* sawtooth: number of ascending runs */
+};
+
+/* constants */
+const int GENERATOR_GRAIN = 1 << 16;  /* Elements generated per task */
+
+/* function declarations */
+bool generate_datasets (DatasetStore& store, const std::vector<const char *>& specs);
+bool parse_generator_spec (const char *text, int index, GeneratorSpec& spec);
+void generate_dataset (const GeneratorSpec& spec, std::vector<int>& dataset);
+std::uint64_t random_at (std::uint64_t seed, std::uint64_t index);
+
+#endif // GENERATOR_H
@@ -0,0 +1,152 @@
+/**
+ * Heap Sort variants that trade the textbook layout of heap_sort() for
+ * fewer cache misses and comparisons. Each sifts with a hole, holding the
+ * sifted element aside and moving children up into the hole, instead of
+ * swapping at every level. The d-ary heaps give each node D children stored
+ * next to each other, so a heap of n elements is only log_D n levels deep
+ * and the children compared at each level share one or two cache lines.
+ * The bottom-up variant, after Floyd and Wegener, first follows the larger
+ * children from the hole down to a leaf with one comparison per level, and
+ * then climbs back up to where the sifted element belongs, which is usually
+ * near the bottom, since elements taken from the end of the heap are small.
+ */
+
+#ifndef HEAPSORT_H
+#define HEAPSORT_H
+
+/* include statements */
+#include <utility>
+
+/* function declarations */
+template <int D, typename T, typename Compare>
+void d_ary_heap_sort (T *v, int n, Compare comp);
+template <typename T, typename Compare>
+void bottom_up_heap_sort (T *v, int n, Compare comp);
+
+template <int D, typename T, typename Compare>
+void d_ary_sift_down (T *v, int n, int hole, T x, Compare comp);
+template <typename T, typename Compare>
+void bottom_up_sift_down (T *v, int n, int hole, T x, Compare comp);
+
+/*
+ * Sort the n elements of the given list in place using a Heap Sort on a
+ * max heap in which the children of v[i] are v[D * i + 1] to v[D * i + D].
+ */
+template <int D, typename T, typename Compare>
+void d_ary_heap_sort (T *v, int n, Compare comp)
+{
+    int i;  /* Index */
+
+    if (n < 2)
+        return;
+
+    for (i = (n - 2) / D; i >= 0; --i)
+        d_ary_sift_down<D>(v, n, i, std::move(v[i]), comp);
+
+    /* Move the largest element to the end, and sift the element it
+     * displaces down from the root of the shortened heap */
+    for (i = n - 1; i > 0; --i) {
+        T x = std::move(v[i]);
+
+        v[i] = std::move(v[0]);
+        d_ary_sift_down<D>(v, i, 0, std::move(x), comp);
+    }
+}
+
+/*
+ * Sort the n elements of the given list in place using a Heap Sort on a
+ * binary max heap, sifting bottom-up.
+ */
+template <typename T, typename Compare>
+void bottom_up_heap_sort (T *v, int n, Compare comp)
+{
+    int i;  /* Index */
+
+    if (n < 2)
+        return;
+
+    for (i = n / 2 - 1; i >= 0; --i)
+        bottom_up_sift_down(v, n, i, std::move(v[i]), comp);
+
+    for (i = n - 1; i > 0; --i) {
+        T x = std::move(v[i]);
+
+        v[i] = std::move(v[0]);
+        bottom_up_sift_down(v, i, 0, std::move(x), comp);
+    }
+}
+
+/*
+ * Helper function for the d-ary Heap Sort that places x in the max heap of
+ * size n at the hole at the given index, whose subtrees are max heaps, by
+ * moving the largest child up into the hole for as long as it is larger
+ * than x.
+ */
+template <int D, typename T, typename Compare>
+void d_ary_sift_down (T *v, int n, int hole, T x, Compare comp)
+{
+    int first;    /* Index of the hole's first child */
+    int largest;  /* Index of the hole's largest child */
+    int last;     /* Index one past the hole's last child */
+    int c;        /* Index of a child */
+
+    while ((first = D * hole + 1) < n) {
+        largest = first;
+        last = first + D < n ? first + D : n;
+
+        for (c = first + 1; c < last; ++c)
+            if (comp(v[largest], v[c]))
+                largest = c;
+
+        if (!comp(x, v[largest]))
+            break;
+
+        v[hole] = std::move(v[largest]);
+        hole = largest;
+    }
+
+    v[hole] = std::move(x);
+}
+
+/*
+ * Helper function for the bottom-up Heap Sort that places x in the binary
+ * max heap of size n at the hole at the given index, whose subtrees are
+ * max heaps. The larger children are moved up along the path from the hole
+ * to a leaf without comparing them with x, and x then rises from the leaf
+ * past those ancestors on the path that are smaller than it.
+ */
+template <typename T, typename Compare>
+void bottom_up_sift_down (T *v, int n, int hole, T x, Compare comp)
+{
+    const int top = hole;  /* Index x was to be placed at */
+    int child;             /* Index of the hole's larger child */
+    int parent;            /* Index of the hole's parent */
+
+    while ((child = 2 * hole + 2) < n) {
+        if (comp(v[child], v[child - 1]))
+            --child;
+
+        v[hole] = std::move(v[child]);
+        hole = child;
+    }
+
+    /* A last left child without a sibling */
+    if (child == n) {
+        v[hole] = std::move(v[n - 1]);
+        hole = n - 1;
+    }
+
+    while (hole > top) {
+        parent = (hole - 1) / 2;
+
+        if (!comp(v[parent], x))
+            break;
+
+        v[hole] = std::move(v[parent]);
+        hole = parent;
+    }
+
+    v[hole] = std::move(x);
+}
+
+#endif // HEAPSORT_H
@@ -0,0 +1,78 @@
+/**
+ * Indirect sorting, for elements too wide to move cheaply. Instead of the
+ * elements themselves, a sorting algorithm sorts pointers to them, which
+ * are compared through the elements they point at, and the elements are
+ * then moved to their sorted positions once each, by following the cycles
+ * of the permutation the pointers describe. Comparing a direct sort of wide
+ * records with an indirect one shows what moving the payload costs, against
+ * the cache misses of reaching every key through a pointer. An indirect
+ * sort is stable when the algorithm sorting the pointers is.
+ */
+
+#ifndef INDIRECTSORT_H
+#define INDIRECTSORT_H
+
+/* include statements */
+#include <utility>
+
+#include "scratcharena.h"
+
+/* Compares two elements through pointers to them */
+template <typename T>
+struct IndirectLess {
+    bool operator() (const T *a, const T *b) const { return *a < *b; }
+};
+
+/* function declarations */
+template <typename T, typename Sort>
+void indirect_sort (T *v, int n, Sort sort);
+template <typename T>
+void permute_to_pointers (T *v, int n, const T **pointers);
+
+/*
+ * Sort the n elements of the given list in place by calling sort on a list
+ * of pointers to them, with an IndirectLess comparator, and then moving
+ * every element to the position of its pointer.
+ */
+template <typename T, typename Sort>
+void indirect_sort (T *v, int n, Sort sort)
+{
+    ScratchVector<const T *> pointers(n);  /* Pointers to the elements, to sort */
+
+    for (int i = 0; i < n; ++i)
+        pointers[i] = v + i;
+
+    sort(pointers.data(), n);
+    permute_to_pointers(v, n, pointers.data());
+}
+
+/*
+ * Helper function for the indirect sorts that moves the element each of
+ * the n pointers in the given list points at to that pointer's position,
+ * taking each cycle of the permutation in turn, so that every element out
+ * of place is moved once and one element per cycle is held aside. The
+ * pointers are left pointing at their own positions.
+ */
+template <typename T>
+void permute_to_pointers (T *v, int n, const T **pointers)
+{
+    int hole;    /* Position waiting for its element */
+    int source;  /* Position of the element the hole waits for */
+
+    for (int i = 0; i < n; ++i) {
+        if (pointers[i] == v + i)
+            continue;
+
+        T x = std::move(v[i]);
+
+        for (hole = i; (source = pointers[hole] - v) != i; hole = source) {
+            v[hole] = std::move(v[source]);
+            pointers[hole] = v + hole;
+        }
+
+        v[hole] = std::move(x);
+        pointers[hole] = v + hole;
+    }
+}
+
+#endif // INDIRECTSORT_H
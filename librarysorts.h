@@ -0,0 +1,44 @@
+/**
+ * Sorts from the standard library and from third-party libraries, so that
+ * the algorithms of this program are ranked against reference
+ * implementations. std::sort and std::stable_sort are always available, and
+ * std::sort with the par_unseq execution policy is available in builds made
+ * as C++17 or later with a standard library providing <execution>, such as
+ * those of "make release". pdqsort, ips4o and Highway's vqsort are each
+ * available when their headers, <pdqsort.h>, <ips4o.hpp> and
+ * <hwy/contrib/sort/vqsort.h>, are found on the include path at build time;
+ * ips4o and vqsort need C++17 as well, and vqsort also needs its libraries
+ * linked, which the Makefile does when it finds them.
+ */
+
+#ifndef LIBRARYSORTS_H
+#define LIBRARYSORTS_H
+
+/* include statements */
+#include <algorithm>
+
+#if defined(__has_include)
+#if __cplusplus >= 201703L && __has_include(<execution>)
+#include <execution>
+#if defined(__cpp_lib_execution)
+#define SORTCOMPARER_HAVE_PAR_UNSEQ
+#endif
+#endif
+
+#if __has_include(<pdqsort.h>)
+#include <pdqsort.h>
+#define SORTCOMPARER_HAVE_PDQSORT
+#endif
+
+#if __cplusplus >= 201703L && __has_include(<ips4o.hpp>)
+#include <ips4o.hpp>
+#define SORTCOMPARER_HAVE_IPS4O
+#endif
+
+#if __cplusplus >= 201703L && __has_include(<hwy/contrib/sort/vqsort.h>)
+#include <hwy/contrib/sort/vqsort.h>
+#define SORTCOMPARER_HAVE_VQSORT
+#endif
+#endif
+
+#endif // LIBRARYSORTS_H
@@ -0,0 +1,205 @@
+/**
+ * Memory microbenchmarks, run before the measurements with --membench so
+ * that the times of the algorithms can be read against what the machine's
+ * memory can do. Sequential read and write bandwidth are measured over a
+ * buffer several times the size of the last level cache. The latency of
+ * random loads is measured by chasing pointers around a random cycle of
+ * cache lines, so that every load depends on the one before it, in working
+ * sets of half of each cache and in the same large buffer. memcpy
+ * throughput is measured at the size of every dataset, since a dataset
+ * that fits in a cache streams faster than one that does not. Every
+ * measurement is repeated, and its best repetition is kept.
+ *
+ * A sort reads and writes every element at least once, so one memcpy of a
+ * dataset, at the throughput measured for its size, is the floor a sort of
+ * it could approach: its streaming bound. Each cell's time is then also
+ * reported as elements sorted per second per core, counting every thread
+ * of the pool for the parallel algorithms, and as the fraction of the
+ * streaming bound it reaches.
+ */
+
+#include "membench.h"
+
+/* Names of the latency levels, indexed by LatencyLevel */
+static const char *latency_level_names[NUM_LATENCY_LEVELS] = {"L1d", "L2", "LLC",
+    "memory"};
+
+/* Where the results of the read loops and chases are stored, so that they
+ * cannot be optimized away */
+static volatile std::uint64_t membench_sink;
+
+/*
+ * Measure the bandwidth and latency of the memory of a machine with the
+ * given cache sizes into profile.
+ */
+void measure_memory_profile (const CacheSizes& caches, MemoryProfile& profile)
+{
+    const long long half_caches[NUM_LATENCY_LEVELS - 1] = {caches.l1d / 2,
+        caches.l2 / 2, caches.llc / 2};  /* Working sets within each cache */
+
+    profile.buffer_bytes = std::max(MEMBENCH_MIN_BUFFER,
+        MEMBENCH_LLC_MULTIPLE * caches.llc);
+
+    std::vector<std::uint64_t> buffer(profile.buffer_bytes / sizeof(std::uint64_t), 1);
+
+    profile.read_gbps = measure_read_bandwidth(buffer.data(), buffer.size());
+    profile.write_gbps = measure_write_bandwidth(buffer.data(), buffer.size());
+
+    for (int level = 0; level < NUM_LATENCY_LEVELS; ++level) {
+        long long bytes = level == LATENCY_MEMORY ? profile.buffer_bytes :
+            half_caches[level];  /* Working set of the level */
+
+        /* A cache of unknown size, or one too small to hold two lines, has
+         * no working set of its own */
+        if (bytes < 2 * CACHE_LINE_BYTES)
+            bytes = 0;
+
+        profile.latency_bytes[level] = bytes;
+        profile.latency_ns[level] = bytes ? measure_load_latency(buffer.data(), bytes) : 0;
+    }
+}
+
+/*
+ * Return the sequential read bandwidth in gigabytes per second, best of
+ * MEMBENCH_REPEATS passes summing the given buffer of words.
+ */
+double measure_read_bandwidth (const std::uint64_t *buffer, std::size_t words)
+{
+    double best_ns = 0;  /* Time of the fastest pass */
+
+    for (int r = 0; r < MEMBENCH_REPEATS; ++r) {
+        std::uint64_t sums[4] = {0, 0, 0, 0};  /* Independent sums, so loads overlap */
+        Clock::time_point start = Clock::now();
+
+        for (std::size_t i = 0; i + 4 <= words; i += 4) {
+            sums[0] += buffer[i];
+            sums[1] += buffer[i + 1];
+            sums[2] += buffer[i + 2];
+            sums[3] += buffer[i + 3];
+        }
+
+        const double ns = elapsed_ns(start, Clock::now());
+
+        membench_sink = sums[0] + sums[1] + sums[2] + sums[3];
+        if (r == 0 || ns < best_ns)
+            best_ns = ns;
+    }
+
+    return words * sizeof(std::uint64_t) / std::max(best_ns, 1.0);
+}
+
+/*
+ * Return the sequential write bandwidth in gigabytes per second, best of
+ * MEMBENCH_REPEATS passes filling the given buffer of words.
+ */
+double measure_write_bandwidth (std::uint64_t *buffer, std::size_t words)
+{
+    double best_ns = 0;  /* Time of the fastest pass */
+
+    for (int r = 0; r < MEMBENCH_REPEATS; ++r) {
+        Clock::time_point start = Clock::now();
+
+        std::memset(buffer, r + 1, words * sizeof(std::uint64_t));
+
+        const double ns = elapsed_ns(start, Clock::now());
+
+        membench_sink = buffer[words / 2];
+        if (r == 0 || ns < best_ns)
+            best_ns = ns;
+    }
+
+    return words * sizeof(std::uint64_t) / std::max(best_ns, 1.0);
+}
+
+/*
+ * Return the mean time in nanoseconds of a load that depends on the one
+ * before it, best of MEMBENCH_REPEATS chases of MEMBENCH_CHASE_LOADS loads
+ * each, around a random cycle through every cache line of the first bytes
+ * of the given buffer, which is overwritten.
+ */
+double measure_load_latency (std::uint64_t *buffer, long long bytes)
+{
+    const std::size_t stride = CACHE_LINE_BYTES / sizeof(std::uint64_t);  /* Words per line */
+    const std::size_t lines = bytes / CACHE_LINE_BYTES;  /* Lines in the cycle */
+    std::vector<std::size_t> order(lines);  /* Lines in the order they are visited */
+    double best_ns = 0;                     /* Time of the fastest chase */
+    std::size_t p = 0;                      /* Word the chase is at */
+
+    /* A Fisher-Yates shuffle of the lines, each then linked to the next, so
+     * that the hardware prefetchers cannot predict the loads */
+    for (std::size_t i = 0; i < lines; ++i)
+        order[i] = i;
+
+    for (std::size_t i = lines - 1; i > 0; --i)
+        std::swap(order[i], order[random_at(lines, i) % (i + 1)]);
+
+    for (std::size_t i = 0; i < lines; ++i)
+        buffer[order[i] * stride] = order[(i + 1) % lines] * stride;
+
+    for (int r = 0; r < MEMBENCH_REPEATS; ++r) {
+        Clock::time_point start = Clock::now();
+
+        for (int i = 0; i < MEMBENCH_CHASE_LOADS; ++i)
+            p = buffer[p];
+
+        const double ns = elapsed_ns(start, Clock::now());
+
+        membench_sink = p;
+        if (r == 0 || ns < best_ns)
+            best_ns = ns;
+    }
+
+    return best_ns / MEMBENCH_CHASE_LOADS;
+}
+
+/*
+ * Return the throughput of memcpy in gigabytes copied per second between
+ * two buffers of the given number of bytes, best of MEMBENCH_REPEATS
+ * repetitions each copying at least MEMBENCH_COPY_BYTES, or the buffer once.
+ */
+double measure_copy_bandwidth (long long bytes)
+{
+    const long long copies = std::max(1LL, MEMBENCH_COPY_BYTES / std::max(bytes, 1LL));
+    std::vector<char> src(bytes, 1), dst(bytes, 0);  /* Buffers copied between */
+    double best_ns = 0;                              /* Time of the fastest repetition */
+
+    if (bytes <= 0)
+        return 0;
+
+    /* Warm the buffers into whichever cache they fit in, as the dataset
+     * would be when a sort of it starts */
+    std::memcpy(dst.data(), src.data(), bytes);
+
+    for (int r = 0; r < MEMBENCH_REPEATS; ++r) {
+        Clock::time_point start = Clock::now();
+
+        for (long long c = 0; c < copies; ++c) {
+            std::memcpy(dst.data(), src.data(), bytes);
+            src[c % bytes] = (char) c;
+        }
+
+        const double ns = elapsed_ns(start, Clock::now());
+
+        membench_sink = dst[bytes / 2];
+        if (r == 0 || ns < best_ns)
+            best_ns = ns;
+    }
+
+    return copies * bytes / std::max(best_ns, 1.0);
+}
+
+/*
+ * Return the name of the given latency level.
+ */
+const char *latency_level_name (int level)
+{
+    return latency_level_names[level];
+}
+
+/*
+ * Return the nanoseconds between the two given times.
+ */
+double elapsed_ns (Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
@@ -0,0 +1,69 @@
+/**
+ * Memory microbenchmarks, run before the measurements with --membench so
+ * that the times of the algorithms can be read against what the machine's
+ * memory can do. Sequential read and write bandwidth are measured over a
+ * buffer several times the size of the last level cache. The latency of
+ * random loads is measured by chasing pointers around a random cycle of
+ * cache lines, so that every load depends on the one before it, in working
+ * sets of half of each cache and in the same large buffer. memcpy
+ * throughput is measured at the size of every dataset, since a dataset
+ * that fits in a cache streams faster than one that does not. Every
+ * measurement is repeated, and its best repetition is kept.
+ *
+ * A sort reads and writes every element at least once, so one memcpy of a
+ * dataset, at the throughput measured for its size, is the floor a sort of
+ * it could approach: its streaming bound. Each cell's time is then also
+ * reported as elements sorted per second per core, counting every thread
+ * of the pool for the parallel algorithms, and as the fraction of the
+ * streaming bound it reaches.
+ */
+
+#ifndef MEMBENCH_H
+#define MEMBENCH_H
+
+/* include statements */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "benchmark.h"
+#include "generator.h"
+#include "sweep.h"
+
+/* The working sets random load latency is measured in */
+enum LatencyLevel {
+    LATENCY_L1D,     /* Half of the level 1 data cache */
+    LATENCY_L2,      /* Half of the level 2 cache */
+    LATENCY_LLC,     /* Half of the last level cache */
+    LATENCY_MEMORY,  /* The bandwidth buffer, beyond every cache */
+    NUM_LATENCY_LEVELS
+};
+
+/* What the memory of the machine was measured to do */
+struct MemoryProfile {
+    long long buffer_bytes;                       /* Size of the bandwidth buffer */
+    double read_gbps;                             /* Sequential read bandwidth */
+    double write_gbps;                            /* Sequential write bandwidth */
+    long long latency_bytes[NUM_LATENCY_LEVELS];  /* Working set of each level, or 0 */
+    double latency_ns[NUM_LATENCY_LEVELS];        /* Mean time of a dependent load */
+};
+
+/* constants */
+const long long MEMBENCH_MIN_BUFFER = 64LL << 20;  /* Smallest bandwidth buffer */
+const int MEMBENCH_LLC_MULTIPLE = 4;               /* Buffer size over the LLC's */
+const int MEMBENCH_REPEATS = 3;                    /* Repetitions of each measurement */
+const int MEMBENCH_CHASE_LOADS = 1 << 21;          /* Loads timed per repetition */
+const long long MEMBENCH_COPY_BYTES = 256LL << 20; /* Bytes copied per repetition */
+const int CACHE_LINE_BYTES = 64;                   /* Stride of the pointer chase */
+
+/* function declarations */
+void measure_memory_profile (const CacheSizes& caches, MemoryProfile& profile);
+double measure_read_bandwidth (const std::uint64_t *buffer, std::size_t words);
+double measure_write_bandwidth (std::uint64_t *buffer, std::size_t words);
+double measure_load_latency (std::uint64_t *buffer, long long bytes);
+double measure_copy_bandwidth (long long bytes);
+const char *latency_level_name (int level);
+double elapsed_ns (Clock::time_point start, Clock::time_point end);
+
+#endif // MEMBENCH_H
@@ -0,0 +1,111 @@
+/**
+ * Operation counting for the instrumented build. Compiling with
+ * SORTCOMPARER_COUNT_OPS defined, as "make counted" does, benchmarks every
+ * algorithm on Counted elements instead of plain ones. A Counted element
+ * counts each comparison, each swap, and each write of an element outside a
+ * swap, including copies into temporaries such as pivots and auxiliary
+ * buffers, in process-wide counters that the timing engine reads around
+ * every timed trial. Normal builds benchmark the plain element types, and
+ * none of this code is on their path.
+ */
+
+#ifndef OPCOUNT_H
+#define OPCOUNT_H
+
+/* include statements */
+#include <atomic>
+#include <utility>
+
+/* Counts of the operations of one run, or their means over several runs */
+struct OpCounts {
+    double comparisons;
+    double swaps;
+    double writes;
+};
+
+/* The counters updated by Counted elements, shared by all threads */
+struct OpCounters {
+    std::atomic<long long> comparisons;
+    std::atomic<long long> swaps;
+    std::atomic<long long> writes;
+};
+
+/*
+ * Return the process-wide operation counters.
+ */
+inline OpCounters& op_counters ()
+{
+    static OpCounters counters;
+
+    return counters;
+}
+
+/* An element of type T whose comparisons, swaps and writes are counted */
+template <typename T>
+struct Counted {
+    T value;
+
+    Counted () : value() {}
+    explicit Counted (const T& v) : value(v) {}
+
+    Counted (const Counted& other) : value(other.value)
+    {
+        op_counters().writes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Counted& operator= (const Counted& other)
+    {
+        value = other.value;
+        op_counters().writes.fetch_add(1, std::memory_order_relaxed);
+        return *this;
+    }
+};
+
+#ifdef SORTCOMPARER_COUNT_OPS
+/* The type the algorithms are benchmarked on for each element type T */
+template <typename T> using Benchmarked = Counted<T>;
+#else
+template <typename T> using Benchmarked = T;
+#endif
+
+/*
+ * Return whether element a is less than element b, counting the comparison.
+ */
+template <typename T>
+inline bool operator< (const Counted<T>& a, const Counted<T>& b)
+{
+    op_counters().comparisons.fetch_add(1, std::memory_order_relaxed);
+    return a.value < b.value;
+}
+
+/*
+ * Exchange elements a and b, counting one swap rather than three writes.
+ */
+template <typename T>
+inline void swap (Counted<T>& a, Counted<T>& b)
+{
+    op_counters().swaps.fetch_add(1, std::memory_order_relaxed);
+    std::swap(a.value, b.value);
+}
+
+/*
+ * Zero the process-wide operation counters.
+ */
+inline void reset_op_counts ()
+{
+    op_counters().comparisons.store(0);
+    op_counters().swaps.store(0);
+    op_counters().writes.store(0);
+}
+
+/*
+ * Add the operations counted since the last reset to totals.
+ */
+inline void add_op_counts (OpCounts& totals)
+{
+    totals.comparisons += op_counters().comparisons.load();
+    totals.swaps += op_counters().swaps.load();
+    totals.writes += op_counters().writes.load();
+}
+
+#endif // OPCOUNT_H
@@ -0,0 +1,242 @@
+/**
+ * Task-parallel versions of Merge Sort and Quick Sort, running on the
+ * shared work-stealing thread pool. Both split the list recursively into
+ * tasks until sublists fall below PARALLEL_GRAIN elements, which are then
+ * finished by the serial algorithms.
+ */
+
+#ifndef PARALLELSORT_H
+#define PARALLELSORT_H
+
+/* include statements */
+#include <algorithm>
+#include <vector>
+
+#include "sortalgos.h"
+#include "threadpool.h"
+
+/* constants */
+const int PARALLEL_GRAIN = 16384;  /* Sublists at or below this length are sorted serially */
+
+/* function declarations */
+template <typename T, typename Compare> void parallel_merge_sort (T *v, int n, Compare comp);
+template <typename T, typename Compare> void parallel_quick_sort (T *v, int n, Compare comp);
+
+template <typename T, typename Compare>
+void parallel_merge_sort_sublist (T *src, T *dst, int start, int end, Compare comp);
+template <typename T, typename Compare>
+void parallel_merge (const T *src, T *dst, int start, int middle, int end,
+    Compare comp);
+template <typename T, typename Compare>
+int co_rank (int k, const T *a, int m, const T *b, int n, Compare comp);
+template <typename T, typename Compare>
+void merge_ranges (const T *a, int m, const T *b, int n, T *out, Compare comp);
+template <typename T, typename Compare>
+void parallel_quick_sort_sublist (T *v, int start, int end, int depth_limit,
+    TaskGroup& group, Compare comp);
+
+/*
+ * Sort the n elements of the given list in place using a parallel Merge
+ * Sort. The two halves of each sublist are sorted concurrently, and large
+ * merges are themselves split into independent pieces by co-ranking.
+ */
+template <typename T, typename Compare>
+void parallel_merge_sort (T *v, int n, Compare comp)
+{
+    if (n < 2)
+        return;
+
+    ScratchVector<T> buffer(v, v + n);
+
+    parallel_merge_sort_sublist(buffer.data(), v, 0, n - 1, comp);
+}
+
+/*
+ * Helper function for the parallel Merge Sort that sorts dst[start..end],
+ * with the same ping-pong contract as merge_sort_sublist(): on entry
+ * src[start..end] must hold the same elements, and is used as the auxiliary
+ * buffer.
+ */
+template <typename T, typename Compare>
+void parallel_merge_sort_sublist (T *src, T *dst, int start, int end, Compare comp)
+{
+    int middle;       /* Middle index of the sublist */
+    TaskGroup group;  /* The task sorting the left half */
+
+    if (end - start + 1 <= PARALLEL_GRAIN) {
+        merge_sort_sublist(src, dst, start, end, comp);
+        return;
+    }
+
+    middle = start + ((end - start) / 2);
+
+    thread_pool().submit(group, [=] {
+        parallel_merge_sort_sublist(dst, src, start, middle, comp);
+    });
+    parallel_merge_sort_sublist(dst, src, middle + 1, end, comp);
+    thread_pool().wait(group);
+
+    parallel_merge(src, dst, start, middle, end, comp);
+}
+
+/*
+ * Helper function for the parallel Merge Sort that merges the sorted
+ * sublists src[start..middle] and src[middle + 1..end] into dst[start..end].
+ * The output is cut into equal pieces, and for each cut the co-rank gives
+ * how many of the elements before it come from each input, so the pieces
+ * can be merged independently and in parallel.
+ */
+template <typename T, typename Compare>
+void parallel_merge (const T *src, T *dst, int start, int middle, int end,
+    Compare comp)
+{
+    const T *a;       /* Left input sublist */
+    const T *b;       /* Right input sublist */
+    int m, n;         /* Lengths of the left and right input sublists */
+    int pieces;       /* Number of pieces the output is cut into */
+    TaskGroup group;  /* The tasks merging all pieces but the last */
+
+    a = src + start;
+    b = src + middle + 1;
+    m = middle - start + 1;
+    n = end - middle;
+
+    pieces = std::min((m + n) / PARALLEL_GRAIN, 4 * thread_pool().num_threads());
+
+    if (pieces < 2) {
+        merge_ranges(a, m, b, n, dst + start, comp);
+        return;
+    }
+
+    for (int p = 0; p < pieces; ++p) {
+        auto merge_piece = [=] {
+            int k0 = (int) ((long long) (m + n) * p / pieces);
+            int k1 = (int) ((long long) (m + n) * (p + 1) / pieces);
+            int i0 = co_rank(k0, a, m, b, n, comp);
+            int i1 = co_rank(k1, a, m, b, n, comp);
+
+            merge_ranges(a + i0, i1 - i0, b + (k0 - i0), (k1 - i1) - (k0 - i0),
+                dst + start + k0, comp);
+        };
+
+        if (p == pieces - 1)
+            merge_piece();
+        else
+            thread_pool().submit(group, merge_piece);
+    }
+
+    thread_pool().wait(group);
+}
+
+/*
+ * Return the co-rank of output position k when merging the sorted lists
+ * a[0..m - 1] and b[0..n - 1]: the number i of elements of a among the first
+ * k elements of the merged list, with the remaining k - i coming from b.
+ * Ties are resolved in favour of a, matching a stable merge.
+ */
+template <typename T, typename Compare>
+int co_rank (int k, const T *a, int m, const T *b, int n, Compare comp)
+{
+    int lo, hi;  /* Bounds of the binary search over i */
+    int i, j;    /* Candidate counts taken from a and b */
+
+    lo = std::max(0, k - n);
+    hi = std::min(k, m);
+
+    /* If a[i] belongs before b[j - 1] in the merged list, too few elements
+     * of a have been taken. This test is monotone in i. */
+    while (lo < hi) {
+        i = lo + (hi - lo) / 2;
+        j = k - i;
+
+        if (j > 0 && !comp(b[j - 1], a[i]))
+            lo = i + 1;
+        else
+            hi = i;
+    }
+
+    return lo;
+}
+
+/*
+ * Merge the sorted lists a[0..m - 1] and b[0..n - 1] into out, taking from a
+ * on ties.
+ */
+template <typename T, typename Compare>
+void merge_ranges (const T *a, int m, const T *b, int n, T *out, Compare comp)
+{
+    int i, j, k;  /* Indices into a, b and out */
+
+    i = j = k = 0;
+
+    while (i < m && j < n) {
+        if (!comp(b[j], a[i]))
+            out[k++] = a[i++];
+        else
+            out[k++] = b[j++];
+    }
+
+    while (i < m)
+        out[k++] = a[i++];
+
+    while (j < n)
+        out[k++] = b[j++];
+}
+
+/*
+ * Sort the n elements of the given list in place using a parallel Quick
+ * Sort. Partitioning is the same as in the introsort Quick Sort; after each
+ * partition of a sublist above PARALLEL_GRAIN elements, the smaller side is
+ * handed to the pool as a new task and the larger side is partitioned
+ * further by the current task.
+ */
+template <typename T, typename Compare>
+void parallel_quick_sort (T *v, int n, Compare comp)
+{
+    TaskGroup group;  /* Every task spawned while sorting the list */
+
+    parallel_quick_sort_sublist(v, 0, n - 1, intro_depth_limit(n), group, comp);
+    thread_pool().wait(group);
+}
+
+/*
+ * Helper function for the parallel Quick Sort that sorts v[start..end],
+ * adding any tasks it spawns to the given group.
+ */
+template <typename T, typename Compare>
+void parallel_quick_sort_sublist (T *v, int start, int end, int depth_limit,
+    TaskGroup& group, Compare comp)
+{
+    int left_end;     /* Last index of the sublist left of the pivot(s) */
+    int right_start;  /* First index of the sublist right of the pivot(s) */
+    int task_start;   /* First index of the sublist handed to a new task */
+    int task_end;     /* Last index of the sublist handed to a new task */
+
+    while (end - start + 1 > PARALLEL_GRAIN) {
+        if (depth_limit == 0) {
+            heap_sort(v + start, end - start + 1, comp);
+            return;
+        }
+
+        --depth_limit;
+        intro_partition(v, start, end, left_end, right_start, comp);
+
+        if (left_end - start < end - right_start) {
+            task_start = start;
+            task_end = left_end;
+            start = right_start;
+        } else {
+            task_start = right_start;
+            task_end = end;
+            end = left_end;
+        }
+
+        thread_pool().submit(group, [=, &group] {
+            parallel_quick_sort_sublist(v, task_start, task_end, depth_limit, group, comp);
+        });
+    }
+
+    intro_sort_sublist(v, start, end, depth_limit, comp);
+}
+
+#endif // PARALLELSORT_H
@@ -0,0 +1,429 @@
+/**
+ * Pattern-defeating Quick Sort, after Orson Peters' pdqsort. Sublists are
+ * partitioned in blocks, as in Edelkamp and Weiss' BlockQuicksort: the
+ * offsets of the elements on the wrong side are first gathered from a block
+ * of 64 elements at each end, with each comparison adding to a count rather
+ * than deciding a branch, and the gathered elements are then exchanged in
+ * a cyclic permutation, so that random data costs no branch mispredictions
+ * in the comparisons. A partition that found the sublist already split
+ * around the pivot is a sign of sorted input, so both sides are first
+ * tried with an Insertion Sort that gives up after a few moves. A very
+ * unbalanced partition instead swaps a few elements of each side to break
+ * up the pattern that caused it, and a sublist that keeps being partitioned
+ * badly is left to Heap Sort. As in the introsort, a pivot equal to the
+ * pivot of the enclosing partition means many duplicates, which are then
+ * put in place all at once.
+ *
+ * Short sublists are finished by an Insertion Sort that moves elements
+ * through a hole instead of swapping them, and that, for every sublist but
+ * the leftmost, needs no bounds check, since the element before the
+ * sublist is no greater than any in it.
+ */
+
+#ifndef PATTERNSORT_H
+#define PATTERNSORT_H
+
+/* include statements */
+#include <algorithm>
+#include <utility>
+
+#include "sortalgos.h"
+
+/* constants */
+const int PDQ_INSERTION_CUTOFF = 24;   /* Sublists below this length use Insertion Sort */
+const int PDQ_NINTHER_CUTOFF = 128;    /* Sublists above this length pivot on a ninther */
+const int PDQ_PARTIAL_INSERTION_LIMIT = 8;  /* Moves before a partial Insertion Sort gives up */
+const int PDQ_BLOCK_SIZE = 64;         /* Elements per block of a block partition */
+
+/* function declarations */
+template <typename T, typename Compare> void pdq_sort (T *v, int n, Compare comp);
+
+template <typename T, typename Compare>
+void pdq_sort_sublist (T *v, int begin, int end, int bad_allowed, bool leftmost,
+    Compare comp);
+template <typename T, typename Compare>
+int pdq_partition_right (T *v, int begin, int end, bool& already_partitioned,
+    Compare comp);
+template <typename T, typename Compare>
+int pdq_partition_left (T *v, int begin, int end, Compare comp);
+template <typename T>
+void pdq_swap_offsets (T *left_base, T *right_base, const unsigned char *offsets_l,
+    const unsigned char *offsets_r, int num, bool use_swaps);
+template <typename T, typename Compare>
+void hole_insertion_sort (T *v, int begin, int end, bool guarded, Compare comp);
+template <typename T, typename Compare>
+bool partial_insertion_sort (T *v, int begin, int end, Compare comp);
+template <typename T, typename Compare>
+void sort_three (T *v, int a, int b, int c, Compare comp);
+template <typename T, typename Compare>
+inline void sort_two (T *v, int a, int b, Compare comp);
+
+/*
+ * Sort the n elements of the given list in place using Pattern-defeating
+ * Quick Sort.
+ */
+template <typename T, typename Compare>
+void pdq_sort (T *v, int n, Compare comp)
+{
+    int bad_allowed;  /* Unbalanced partitions allowed before Heap Sort */
+
+    bad_allowed = 0;
+    for (int m = n; m > 1; m /= 2)
+        ++bad_allowed;
+
+    pdq_sort_sublist(v, 0, n, bad_allowed, true, comp);
+}
+
+/*
+ * Helper function for Pattern-defeating Quick Sort that sorts the elements
+ * of the given list from index begin up to end, allowing bad_allowed more
+ * unbalanced partitions before falling back to Heap Sort. Unless leftmost
+ * is set, v[begin - 1] is no greater than any element of the sublist.
+ */
+template <typename T, typename Compare>
+void pdq_sort_sublist (T *v, int begin, int end, int bad_allowed, bool leftmost,
+    Compare comp)
+{
+    int size;                   /* Length of the sublist */
+    int half;                   /* Half the length of the sublist */
+    int pivot;                  /* Final index of the pivot */
+    int left_size, right_size;  /* Lengths of the sublists either side of it */
+    bool already_partitioned;   /* Whether partitioning moved no elements */
+
+    while (true) {
+        size = end - begin;
+
+        if (size < PDQ_INSERTION_CUTOFF) {
+            hole_insertion_sort(v, begin, end, leftmost, comp);
+            return;
+        }
+
+        /* Move the median of three, or of a ninther, to v[begin] */
+        half = size / 2;
+        if (size > PDQ_NINTHER_CUTOFF) {
+            sort_three(v, begin, begin + half, end - 1, comp);
+            sort_three(v, begin + 1, begin + half - 1, end - 2, comp);
+            sort_three(v, begin + 2, begin + half + 1, end - 3, comp);
+            sort_three(v, begin + half - 1, begin + half, begin + half + 1, comp);
+            swap_elements(v[begin], v[begin + half]);
+        } else {
+            sort_three(v, begin + half, begin, end - 1, comp);
+        }
+
+        /* A pivot equal to the element before the sublist is its minimum,
+         * so all of its copies can be put in place together */
+        if (!leftmost && !comp(v[begin - 1], v[begin])) {
+            begin = pdq_partition_left(v, begin, end, comp) + 1;
+            continue;
+        }
+
+        pivot = pdq_partition_right(v, begin, end, already_partitioned, comp);
+        left_size = pivot - begin;
+        right_size = end - (pivot + 1);
+
+        if (left_size < size / 8 || right_size < size / 8) {
+            if (--bad_allowed == 0) {
+                heap_sort(v + begin, size, comp);
+                return;
+            }
+
+            /* Swap elements a quarter of the way into each side with their
+             * ends, so the next pivots come from elsewhere */
+            if (left_size >= PDQ_INSERTION_CUTOFF) {
+                swap_elements(v[begin], v[begin + left_size / 4]);
+                swap_elements(v[pivot - 1], v[pivot - left_size / 4]);
+
+                if (left_size > PDQ_NINTHER_CUTOFF) {
+                    swap_elements(v[begin + 1], v[begin + (left_size / 4 + 1)]);
+                    swap_elements(v[begin + 2], v[begin + (left_size / 4 + 2)]);
+                    swap_elements(v[pivot - 2], v[pivot - (left_size / 4 + 1)]);
+                    swap_elements(v[pivot - 3], v[pivot - (left_size / 4 + 2)]);
+                }
+            }
+
+            if (right_size >= PDQ_INSERTION_CUTOFF) {
+                swap_elements(v[pivot + 1], v[pivot + (1 + right_size / 4)]);
+                swap_elements(v[end - 1], v[end - right_size / 4]);
+
+                if (right_size > PDQ_NINTHER_CUTOFF) {
+                    swap_elements(v[pivot + 2], v[pivot + (2 + right_size / 4)]);
+                    swap_elements(v[pivot + 3], v[pivot + (3 + right_size / 4)]);
+                    swap_elements(v[end - 2], v[end - (1 + right_size / 4)]);
+                    swap_elements(v[end - 3], v[end - (2 + right_size / 4)]);
+                }
+            }
+        } else if (already_partitioned && partial_insertion_sort(v, begin, pivot, comp) &&
+            partial_insertion_sort(v, pivot + 1, end, comp)) {
+            /* The partition was balanced and both sides were nearly sorted */
+            return;
+        }
+
+        pdq_sort_sublist(v, begin, pivot, bad_allowed, leftmost, comp);
+        begin = pivot + 1;
+        leftmost = false;
+    }
+}
+
+/*
+ * Helper function for Pattern-defeating Quick Sort that partitions the
+ * elements of the given list from index begin up to end around the pivot
+ * at v[begin], in blocks, and returns the pivot's final index. Elements
+ * equal to the pivot go to its right. already_partitioned is set if no
+ * element needed to move.
+ */
+template <typename T, typename Compare>
+int pdq_partition_right (T *v, int begin, int end, bool& already_partitioned,
+    Compare comp)
+{
+    T pivot = std::move(v[begin]);  /* Value of the pivot */
+    int first = begin;              /* First element not known to be below the pivot */
+    int last = end;                 /* Last element not known to not be below it, plus one */
+    alignas(64) unsigned char offsets_l[PDQ_BLOCK_SIZE];  /* Left elements to move */
+    alignas(64) unsigned char offsets_r[PDQ_BLOCK_SIZE];  /* Right elements to move */
+    int num_l = 0, num_r = 0;       /* Offsets left in each block */
+    int start_l = 0, start_r = 0;   /* First unused offset of each block */
+    int base_l, base_r;             /* Indices the offsets of each block are relative to */
+
+    /* The median of three guarantees an element not below the pivot */
+    while (comp(v[++first], pivot))
+        ;
+
+    /* Only guard the search for an element below the pivot if none was
+     * found before v[first] */
+    if (first - 1 == begin) {
+        while (first < last && !comp(v[--last], pivot))
+            ;
+    } else {
+        while (!comp(v[--last], pivot))
+            ;
+    }
+
+    already_partitioned = first >= last;
+
+    if (!already_partitioned) {
+        swap_elements(v[first], v[last]);
+        ++first;
+        base_l = first;
+        base_r = last;
+
+        while (first < last) {
+            int unknown = last - first;  /* Elements not yet compared */
+            int left_split = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+            int right_split = num_r == 0 ? unknown - left_split : 0;
+            int i;
+
+            /* Refill whichever blocks are empty with the offsets of the
+             * elements on the wrong side, without branching on the
+             * comparisons */
+            left_split = std::min(left_split, PDQ_BLOCK_SIZE);
+            right_split = std::min(right_split, PDQ_BLOCK_SIZE);
+
+            for (i = 0; i < left_split; ++i) {
+                offsets_l[num_l] = i;
+                num_l += !comp(v[first++], pivot);
+            }
+
+            for (i = 0; i < right_split; ) {
+                offsets_r[num_r] = ++i;
+                num_r += comp(v[--last], pivot);
+            }
+
+            int num = std::min(num_l, num_r);  /* Pairs of elements to exchange */
+
+            pdq_swap_offsets(v + base_l, v + base_r, offsets_l + start_l, offsets_r + start_r,
+                num, num_l == num_r);
+            num_l -= num;
+            num_r -= num;
+            start_l += num;
+            start_r += num;
+
+            if (num_l == 0) {
+                start_l = 0;
+                base_l = first;
+            }
+
+            if (num_r == 0) {
+                start_r = 0;
+                base_r = last;
+            }
+        }
+
+        /* Every element is now compared, and the wrong-side elements left
+         * in one block are exchanged with the far end of the other side */
+        if (num_l) {
+            while (num_l--)
+                swap_elements(v[base_l + offsets_l[start_l + num_l]], v[--last]);
+            first = last;
+        }
+
+        if (num_r) {
+            while (num_r--)
+                swap_elements(v[base_r - offsets_r[start_r + num_r]], v[first++]);
+        }
+    }
+
+    v[begin] = std::move(v[first - 1]);
+    v[first - 1] = std::move(pivot);
+
+    return first - 1;
+}
+
+/*
+ * Helper function for Pattern-defeating Quick Sort that partitions the
+ * elements of the given list from index begin up to end around the pivot
+ * at v[begin], which is no greater than any of them, and returns the
+ * pivot's final index. Elements equal to the pivot go to its left, where
+ * they are in their final positions.
+ */
+template <typename T, typename Compare>
+int pdq_partition_left (T *v, int begin, int end, Compare comp)
+{
+    T pivot = std::move(v[begin]);  /* Value of the pivot */
+    int first = begin;              /* Scans forwards for elements above the pivot */
+    int last = end;                 /* Scans backwards for elements not above it */
+
+    while (comp(pivot, v[--last]))
+        ;
+
+    if (last + 1 == end) {
+        while (first < last && !comp(pivot, v[++first]))
+            ;
+    } else {
+        while (!comp(pivot, v[++first]))
+            ;
+    }
+
+    while (first < last) {
+        swap_elements(v[first], v[last]);
+        while (comp(pivot, v[--last]))
+            ;
+        while (!comp(pivot, v[++first]))
+            ;
+    }
+
+    v[begin] = std::move(v[last]);
+    v[last] = std::move(pivot);
+
+    return last;
+}
+
+/*
+ * Helper function for Pattern-defeating Quick Sort that exchanges num pairs
+ * of elements given by their offsets after left_base and before right_base.
+ * Unless use_swaps is set, the pairs are exchanged as one cyclic
+ * permutation, which takes one move per element instead of three; when
+ * both blocks hold the same number of offsets, as on descending input,
+ * plain swaps keep the sort linear.
+ */
+template <typename T>
+void pdq_swap_offsets (T *left_base, T *right_base, const unsigned char *offsets_l,
+    const unsigned char *offsets_r, int num, bool use_swaps)
+{
+    T *l, *r;  /* Current pair of elements */
+    int i;     /* Index */
+
+    if (use_swaps) {
+        for (i = 0; i < num; ++i)
+            swap_elements(left_base[offsets_l[i]], *(right_base - offsets_r[i]));
+    } else if (num > 0) {
+        l = left_base + offsets_l[0];
+        r = right_base - offsets_r[0];
+
+        T x = std::move(*l);
+        *l = std::move(*r);
+
+        for (i = 1; i < num; ++i) {
+            l = left_base + offsets_l[i];
+            *r = std::move(*l);
+            r = right_base - offsets_r[i];
+            *l = std::move(*r);
+        }
+
+        *r = std::move(x);
+    }
+}
+
+/*
+ * Sort the elements of the given list from index begin up to end in place
+ * using Insertion Sort, moving elements through a hole. Unless guarded is
+ * set, v[begin - 1] is no greater than any element of the sublist, and
+ * stops every element from moving past the start.
+ */
+template <typename T, typename Compare>
+void hole_insertion_sort (T *v, int begin, int end, bool guarded, Compare comp)
+{
+    int i, j;  /* Indices */
+
+    for (i = begin + 1; i < end; ++i) {
+        if (!comp(v[i], v[i - 1]))
+            continue;
+
+        T x = std::move(v[i]);
+
+        if (guarded) {
+            for (j = i; j > begin && comp(x, v[j - 1]); --j)
+                v[j] = std::move(v[j - 1]);
+        } else {
+            for (j = i; comp(x, v[j - 1]); --j)
+                v[j] = std::move(v[j - 1]);
+        }
+
+        v[j] = std::move(x);
+    }
+}
+
+/*
+ * Attempt to sort the elements of the given list from index begin up to
+ * end with Insertion Sort, giving up once more than
+ * PDQ_PARTIAL_INSERTION_LIMIT elements have been moved. Return whether the
+ * sublist was sorted.
+ */
+template <typename T, typename Compare>
+bool partial_insertion_sort (T *v, int begin, int end, Compare comp)
+{
+    int moves;  /* Elements moved so far */
+    int i, j;   /* Indices */
+
+    moves = 0;
+
+    for (i = begin + 1; i < end; ++i) {
+        if (!comp(v[i], v[i - 1]))
+            continue;
+
+        T x = std::move(v[i]);
+
+        for (j = i; j > begin && comp(x, v[j - 1]); --j)
+            v[j] = std::move(v[j - 1]);
+
+        v[j] = std::move(x);
+        moves += i - j;
+
+        if (moves > PDQ_PARTIAL_INSERTION_LIMIT)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Sort the elements at the indices a, b and c of the given list.
+ */
+template <typename T, typename Compare>
+void sort_three (T *v, int a, int b, int c, Compare comp)
+{
+    sort_two(v, a, b, comp);
+    sort_two(v, b, c, comp);
+    sort_two(v, a, b, comp);
+}
+
+/*
+ * Sort the elements at the indices a and b of the given list.
+ */
+template <typename T, typename Compare>
+inline void sort_two (T *v, int a, int b, Compare comp)
+{
+    if (comp(v[b], v[a]))
+        swap_elements(v[a], v[b]);
+}
+
+#endif // PATTERNSORT_H
@@ -0,0 +1,184 @@
+/**
+ * Optional hardware performance counters around each timed run, read with
+ * perf_event_open on Linux. Cycles, instructions, L1 data cache misses, last
+ * level cache misses, branch mispredictions and page faults are each opened
+ * as a separate user-space counter, so that counters the machine or its
+ * permissions do not offer are simply reported as unavailable. Counters are
+ * inherited by threads created after they are opened, so opening them
+ * before the thread pool is created also counts the work of the parallel
+ * algorithms. Elsewhere, no counter is ever available.
+ */
+
+#include "perfcounters.h"
+
+/* Names of the events, indexed by CounterId */
+static const char *counter_names[NUM_COUNTERS] = {"cycles", "instructions",
+    "L1D misses", "LLC misses", "branch misses", "page faults"};
+
+#ifdef __linux__
+
+/* The perf_event_open type and config of each event, indexed by CounterId */
+static const std::uint64_t counter_events[NUM_COUNTERS][2] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}
+};
+
+/*
+ * Open a disabled counter for every event on the calling thread and the
+ * threads it creates later. Return whether any counter could be opened,
+ * after warning the user if none could.
+ */
+bool open_perf_counters (PerfCounters& counters)
+{
+    bool any_open = false;  /* Whether any counter has been opened */
+    int error = 0;          /* Error of the first counter that failed to open */
+
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        struct perf_event_attr attr;
+
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = counter_events[i][0];
+        attr.config = counter_events[i][1];
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        counters.fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+        if (counters.fds[i] >= 0)
+            any_open = true;
+        else if (error == 0)
+            error = errno;
+    }
+
+    if (!any_open)
+        std::cerr << "WARNING: Performance counters are unavailable ("
+            << std::strerror(error) << "), check /proc/sys/kernel/perf_event_paranoid"
+            << std::endl;
+
+    return any_open;
+}
+
+/*
+ * Close every open counter.
+ */
+void close_perf_counters (PerfCounters& counters)
+{
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        if (counters.fds[i] >= 0)
+            close(counters.fds[i]);
+        counters.fds[i] = -1;
+    }
+}
+
+/*
+ * Reset every open counter and start counting.
+ */
+void start_perf_counters (const PerfCounters& counters)
+{
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        if (counters.fds[i] >= 0) {
+            ioctl(counters.fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters.fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/*
+ * Stop every open counter and add its count since it was started to totals.
+ * If the kernel had to multiplex a counter, its count is scaled up to the
+ * whole time it was enabled.
+ */
+void stop_perf_counters (const PerfCounters& counters, CounterValues& totals)
+{
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+        if (counters.fds[i] >= 0)
+            ioctl(counters.fds[i], PERF_EVENT_IOC_DISABLE, 0);
+
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        std::uint64_t data[3];  /* Count, time enabled and time running */
+
+        if (counters.fds[i] < 0 || read(counters.fds[i], data, sizeof(data)) != sizeof(data))
+            continue;
+
+        if (data[2] > 0 && data[2] < data[1])
+            totals.counts[i] += (double) data[0] * data[1] / data[2];
+        else
+            totals.counts[i] += data[0];
+    }
+}
+
+#else
+
+bool open_perf_counters (PerfCounters& counters)
+{
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+        counters.fds[i] = -1;
+
+    std::cerr << "WARNING: Performance counters are only supported on Linux" << std::endl;
+    return false;
+}
+
+void close_perf_counters (PerfCounters& counters)
+{
+    (void) counters;
+}
+
+void start_perf_counters (const PerfCounters& counters)
+{
+    (void) counters;
+}
+
+void stop_perf_counters (const PerfCounters& counters, CounterValues& totals)
+{
+    (void) counters;
+    (void) totals;
+}
+
+#endif
+
+/*
+ * Zero the given values, marking as valid the events whose counters are
+ * open, or none if there are no counters.
+ */
+void clear_counter_values (const PerfCounters *counters, CounterValues& values)
+{
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        values.counts[i] = 0;
+        values.valid[i] = counters && counters->fds[i] >= 0;
+    }
+}
+
+/*
+ * Multiply every count in the given values by the given factor.
+ */
+void scale_counter_values (CounterValues& values, double factor)
+{
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+        values.counts[i] *= factor;
+}
+
+/*
+ * Add the given values into the running total.
+ */
+void accumulate_counter_values (CounterValues& total, const CounterValues& values)
+{
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+        total.counts[i] += values.counts[i];
+}
+
+/*
+ * Return the name the given event is printed under.
+ */
+const char *counter_name (int id)
+{
+    return counter_names[id];
+}
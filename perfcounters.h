@@ -0,0 +1,60 @@
+/**
+ * Optional hardware performance counters around each timed run, read with
+ * perf_event_open on Linux. Cycles, instructions, L1 data cache misses, last
+ * level cache misses, branch mispredictions and page faults are each opened
+ * as a separate user-space counter, so that counters the machine or its
+ * permissions do not offer are simply reported as unavailable. Counters are
+ * inherited by threads created after they are opened, so opening them
+ * before the thread pool is created also counts the work of the parallel
+ * algorithms. Elsewhere, no counter is ever available.
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+/* include statements */
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* The events counted */
+enum CounterId {
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_L1D_MISSES,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_PAGE_FAULTS,
+    NUM_COUNTERS
+};
+
+/* The open counters of the process */
+struct PerfCounters {
+    int fds[NUM_COUNTERS];   /* File descriptor of each counter, or -1 if unavailable */
+};
+
+/* Counts of each event, over one run or summed over several */
+struct CounterValues {
+    double counts[NUM_COUNTERS];  /* Count of each event */
+    bool valid[NUM_COUNTERS];     /* Whether each event was counted */
+};
+
+/* function declarations */
+bool open_perf_counters (PerfCounters& counters);
+void close_perf_counters (PerfCounters& counters);
+void start_perf_counters (const PerfCounters& counters);
+void stop_perf_counters (const PerfCounters& counters, CounterValues& totals);
+void clear_counter_values (const PerfCounters *counters, CounterValues& values);
+void scale_counter_values (CounterValues& values, double factor);
+void accumulate_counter_values (CounterValues& total, const CounterValues& values);
+const char *counter_name (int id);
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,271 @@
+/**
+ * Non-comparison sorting algorithms: an LSD Radix Sort, an in-place MSD
+ * Radix Sort in the American flag style, and a Counting Sort that takes over
+ * when the range of values is small. Each element type is sorted by an
+ * unsigned key given by RadixTraits, whose unsigned order matches the order
+ * of the elements: signed integers have their sign bit flipped, so negative
+ * values sort before non-negative ones, floating point values additionally
+ * have their other bits inverted when negative, and records use the key of
+ * their key field.
+ */
+
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+/* include statements */
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "elementtypes.h"
+#include "sortalgos.h"
+
+/* constants */
+const int RADIX_BITS = 8;                      /* Bits in each digit */
+const int RADIX_BUCKETS = 1 << RADIX_BITS;     /* Buckets per digit */
+const int MSD_INSERTION_CUTOFF = 32;           /* MSD buckets at or below this length use Insertion Sort */
+const int COUNTING_SORT_RANGE_RATIO = 2;       /* Counting Sort engages while max - min < ratio * n */
+
+/* The unsigned radix key of each element type */
+template <typename T> struct RadixTraits;
+
+template <> struct RadixTraits<int> {
+    using Key = std::uint32_t;
+
+    static Key key (int x) { return (Key) x ^ 0x80000000u; }
+};
+
+template <> struct RadixTraits<std::int64_t> {
+    using Key = std::uint64_t;
+
+    static Key key (std::int64_t x) { return (Key) x ^ 0x8000000000000000ULL; }
+};
+
+template <> struct RadixTraits<float> {
+    using Key = std::uint32_t;
+
+    static Key key (float x)
+    {
+        Key bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+    }
+};
+
+template <> struct RadixTraits<double> {
+    using Key = std::uint64_t;
+
+    static Key key (double x)
+    {
+        Key bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return (bits & 0x8000000000000000ULL) ? ~bits : bits | 0x8000000000000000ULL;
+    }
+};
+
+template <> struct RadixTraits<Record> {
+    using Key = std::uint64_t;
+
+    static Key key (const Record& x) { return RadixTraits<std::int64_t>::key(x.key); }
+};
+
+template <> struct RadixTraits<WideRecord> {
+    using Key = std::uint64_t;
+
+    static Key key (const WideRecord& x) { return RadixTraits<std::int64_t>::key(x.key); }
+};
+
+template <typename T> struct RadixTraits<Counted<T> > {
+    using Key = typename RadixTraits<T>::Key;
+
+    static Key key (const Counted<T>& x) { return RadixTraits<T>::key(x.value); }
+};
+
+/* function declarations */
+template <typename T> void lsd_radix_sort (T *v, int n);
+template <typename T> void msd_radix_sort (T *v, int n);
+template <typename T> void counting_sort (T *v, int n);
+
+template <typename T> void american_flag_sort (T *v, int n, int shift);
+
+/*
+ * Sort the n elements of the given list in place using an LSD Radix Sort
+ * with 8-bit digits. The histograms of all digits are built in a single
+ * pass over the list, and any digit on which every element agrees is skipped
+ * instead of being scattered. Each remaining pass scatters the list between
+ * it and one auxiliary buffer.
+ */
+template <typename T>
+void lsd_radix_sort (T *v, int n)
+{
+    using Traits = RadixTraits<T>;
+    using Key = typename Traits::Key;
+
+    const int passes = sizeof(Key) * CHAR_BIT / RADIX_BITS;
+    int counts[passes][RADIX_BUCKETS];  /* Histogram of each digit */
+    T *src, *dst;                       /* Input and output of a pass */
+
+    if (n < 2)
+        return;
+
+    std::fill(&counts[0][0], &counts[0][0] + passes * RADIX_BUCKETS, 0);
+
+    for (int i = 0; i < n; ++i) {
+        Key key = Traits::key(v[i]);
+
+        for (int pass = 0; pass < passes; ++pass)
+            ++counts[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)];
+    }
+
+    ScratchVector<T> buffer(n);
+    src = v;
+    dst = buffer.data();
+
+    for (int pass = 0; pass < passes; ++pass) {
+        const int shift = pass * RADIX_BITS;
+        int *count = counts[pass];
+
+        /* If every element has the same digit, this pass would not move
+         * anything. */
+        if (count[(Traits::key(src[0]) >> shift) & (RADIX_BUCKETS - 1)] == n)
+            continue;
+
+        /* Turn the histogram into the starting offset of each bucket */
+        int offset = 0;
+        for (int b = 0; b < RADIX_BUCKETS; ++b) {
+            int size = count[b];
+            count[b] = offset;
+            offset += size;
+        }
+
+        for (int i = 0; i < n; ++i)
+            dst[count[(Traits::key(src[i]) >> shift) & (RADIX_BUCKETS - 1)]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    if (src != v)
+        std::copy(src, src + n, v);
+}
+
+/*
+ * Sort the n elements of the given list in place using an MSD Radix Sort
+ * with 8-bit digits, starting from the most significant digit.
+ */
+template <typename T>
+void msd_radix_sort (T *v, int n)
+{
+    const int key_bits = sizeof(typename RadixTraits<T>::Key) * CHAR_BIT;
+
+    american_flag_sort(v, n, key_bits - RADIX_BITS);
+}
+
+/*
+ * Helper function for the MSD Radix Sort that sorts the given list of n
+ * elements, all of which agree on the digits above the given shift. The
+ * digit at the shift is histogrammed and every element is permuted into its
+ * bucket in place by following cycles, as in McIlroy, Bostic and McIlroy's
+ * American flag sort, and then each bucket is sorted on the next digit.
+ */
+template <typename T>
+void american_flag_sort (T *v, int n, int shift)
+{
+    using Traits = RadixTraits<T>;
+
+    int counts[RADIX_BUCKETS];  /* Number of elements in each bucket */
+    int heads[RADIX_BUCKETS];   /* Next unfilled index of each bucket */
+    int tails[RADIX_BUCKETS];   /* End of each bucket */
+
+    if (n <= MSD_INSERTION_CUTOFF) {
+        insertion_sort(v, n, std::less<T>());
+        return;
+    }
+
+    std::fill(counts, counts + RADIX_BUCKETS, 0);
+
+    for (int i = 0; i < n; ++i)
+        ++counts[(Traits::key(v[i]) >> shift) & (RADIX_BUCKETS - 1)];
+
+    int offset = 0;
+    for (int b = 0; b < RADIX_BUCKETS; ++b) {
+        heads[b] = offset;
+        offset += counts[b];
+        tails[b] = offset;
+    }
+
+    /* Fill each bucket in turn. The element at the bucket's head is carried
+     * to the head of the bucket it belongs in, displacing the element there,
+     * until an element belonging in the current bucket turns up. */
+    for (int b = 0; b < RADIX_BUCKETS; ++b) {
+        while (heads[b] < tails[b]) {
+            T x = v[heads[b]];
+            int digit = (Traits::key(x) >> shift) & (RADIX_BUCKETS - 1);
+
+            while (digit != b) {
+                swap_elements(x, v[heads[digit]++]);
+                digit = (Traits::key(x) >> shift) & (RADIX_BUCKETS - 1);
+            }
+
+            v[heads[b]++] = x;
+        }
+    }
+
+    if (shift == 0)
+        return;
+
+    offset = 0;
+    for (int b = 0; b < RADIX_BUCKETS; ++b) {
+        if (counts[b] > 1)
+            american_flag_sort(v + offset, counts[b], shift - RADIX_BITS);
+        offset += counts[b];
+    }
+}
+
+/*
+ * Sort the n elements of the given list in place using Counting Sort, when
+ * the difference between the largest and smallest elements is less than
+ * COUNTING_SORT_RANGE_RATIO times n. Otherwise the counts would take more
+ * memory and time than the list itself, and the LSD Radix Sort is used
+ * instead. The elements are rewritten from their counts, so this only
+ * applies to plain integers.
+ */
+template <typename T>
+void counting_sort (T *v, int n)
+{
+    static_assert(std::is_integral<T>::value, "Counting Sort needs integer elements");
+
+    T min, max;           /* Smallest and largest elements of the list */
+    std::uint64_t span;   /* Difference between max and min */
+
+    if (n < 2)
+        return;
+
+    min = max = v[0];
+    for (int i = 1; i < n; ++i) {
+        min = std::min(min, v[i]);
+        max = std::max(max, v[i]);
+    }
+
+    span = (std::uint64_t) max - (std::uint64_t) min;
+
+    if (span >= (std::uint64_t) COUNTING_SORT_RANGE_RATIO * n) {
+        lsd_radix_sort(v, n);
+        return;
+    }
+
+    ScratchVector<int> counts(span + 1);
+
+    for (int i = 0; i < n; ++i)
+        ++counts[(std::uint64_t) v[i] - (std::uint64_t) min];
+
+    int k = 0;
+    for (std::uint64_t value = 0; value <= span; ++value)
+        for (int c = counts[value]; c > 0; --c)
+            v[k++] = (T) ((std::uint64_t) min + value);
+}
+
+#endif // RADIXSORT_H
@@ -0,0 +1,278 @@
+/**
+ * The registry of sorting algorithms. register_sort_algos() instantiates
+ * every algorithm that applies to an element type with that type and the
+ * default comparator, so that each registered function has its comparisons
+ * inlined, and records it under its display name. The instantiations for
+ * all element types are compiled in registry.cc, and the element type to
+ * benchmark is chosen at run time with --type. register_select_algos()
+ * likewise records the top-k and selection algorithms, which take a rank
+ * k and are measured instead of the sorts when --k is given.
+ */
+
+#include "registry.h"
+#include "adaptivesort.h"
+#include "heapsort.h"
+#include "indirectsort.h"
+#include "librarysorts.h"
+#include "parallelsort.h"
+#include "patternsort.h"
+#include "radixsort.h"
+#include "selection.h"
+#include "shellsort.h"
+#include "simdsort.h"
+#include "sortalgos.h"
+
+/* Names of the element types, indexed by ElementType */
+static const char *element_type_names[] = {"int", "int64", "float", "double", "record",
+    "wide"};
+
+/*
+ * Register the algorithms that only apply to plain integers, including the
+ * vectorized sorts, whose kernels work on 32-bit lanes. Counted elements
+ * are not plain integers, so instrumented builds have none.
+ */
+#ifndef SORTCOMPARER_COUNT_OPS
+static void register_integer_algos (SortAlgoMap<int>& sort_algos)
+{
+    sort_algos["Counting Sort"] = SortAlgoInfo<int>{counting_sort<int>, COMPLEXITY_LINEAR};
+    sort_algos["Merge Sort (SIMD)"] = SortAlgoInfo<int>{simd_merge_sort, COMPLEXITY_N_LOG_N};
+    sort_algos["Quick Sort (SIMD)"] = SortAlgoInfo<int>{simd_quick_sort, COMPLEXITY_N_LOG_N};
+}
+
+static void register_integer_algos (SortAlgoMap<std::int64_t>& sort_algos)
+{
+    sort_algos["Counting Sort"] = SortAlgoInfo<std::int64_t>{counting_sort<std::int64_t>,
+        COMPLEXITY_LINEAR};
+}
+#endif
+
+template <typename T>
+static void register_integer_algos (SortAlgoMap<T>& sort_algos)
+{
+    (void) sort_algos;
+}
+
+/*
+ * Register indirect versions of some of the comparison sorts for wide
+ * records, which sort pointers to the records and then move each record
+ * once, for comparison with the direct sorts that move whole records at
+ * every step. Narrower elements cost no more to move than pointers.
+ */
+static void register_wide_algos (SortAlgoMap<Benchmarked<WideRecord> >& sort_algos)
+{
+    using T = Benchmarked<WideRecord>;
+    using Info = SortAlgoInfo<T>;
+    using Less = IndirectLess<T>;
+
+    sort_algos["Merge Sort (indirect)"] = Info{[] (T *v, int n) {
+        indirect_sort(v, n, [] (const T **p, int m) {
+            merge_sort(p, m, Less()); }); }, COMPLEXITY_N_LOG_N};
+    sort_algos["TimSort (indirect)"] = Info{[] (T *v, int n) {
+        indirect_sort(v, n, [] (const T **p, int m) {
+            adaptive_merge_sort(p, m, POLICY_TIMSORT, Less()); }); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Quick Sort (indirect)"] = Info{[] (T *v, int n) {
+        indirect_sort(v, n, [] (const T **p, int m) {
+            quick_sort(p, m, Less()); }); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Quick Sort (pdq, indirect)"] = Info{[] (T *v, int n) {
+        indirect_sort(v, n, [] (const T **p, int m) {
+            pdq_sort(p, m, Less()); }); }, COMPLEXITY_N_LOG_N};
+}
+
+template <typename T>
+static void register_wide_algos (SortAlgoMap<T>& sort_algos)
+{
+    (void) sort_algos;
+}
+
+/*
+ * Register the library sorts found at build time that apply to any element
+ * type, for comparison with the algorithms of this program.
+ */
+template <typename T>
+static void register_library_algos (SortAlgoMap<T>& sort_algos)
+{
+#ifdef SORTCOMPARER_HAVE_PAR_UNSEQ
+    sort_algos["std::sort (par_unseq)"] = SortAlgoInfo<T>{[] (T *v, int n) {
+        std::sort(std::execution::par_unseq, v, v + n, std::less<T>()); },
+        COMPLEXITY_N_LOG_N, true};
+#endif
+#ifdef SORTCOMPARER_HAVE_PDQSORT
+    sort_algos["pdqsort"] = SortAlgoInfo<T>{[] (T *v, int n) {
+        pdqsort(v, v + n, std::less<T>()); }, COMPLEXITY_N_LOG_N};
+#endif
+#ifdef SORTCOMPARER_HAVE_IPS4O
+    sort_algos["ips4o"] = SortAlgoInfo<T>{[] (T *v, int n) {
+        ips4o::sort(v, v + n, std::less<T>()); }, COMPLEXITY_N_LOG_N};
+#endif
+
+    (void) sort_algos;
+}
+
+/*
+ * Register Highway's vqsort, if it was found at build time, for the plain
+ * integer and floating-point types it sorts. Counted elements are not plain
+ * numbers, so instrumented builds never have it.
+ */
+#if defined(SORTCOMPARER_HAVE_VQSORT) && !defined(SORTCOMPARER_COUNT_OPS)
+template <typename T>
+static void vqsort_sort (T *v, int n)
+{
+    hwy::VQSort(v, n, hwy::SortAscending());
+}
+
+static void register_vqsort_algos (SortAlgoMap<int>& sort_algos)
+{
+    sort_algos["vqsort"] = SortAlgoInfo<int>{vqsort_sort<int>, COMPLEXITY_N_LOG_N};
+}
+
+static void register_vqsort_algos (SortAlgoMap<std::int64_t>& sort_algos)
+{
+    sort_algos["vqsort"] = SortAlgoInfo<std::int64_t>{vqsort_sort<std::int64_t>,
+        COMPLEXITY_N_LOG_N};
+}
+
+static void register_vqsort_algos (SortAlgoMap<float>& sort_algos)
+{
+    sort_algos["vqsort"] = SortAlgoInfo<float>{vqsort_sort<float>, COMPLEXITY_N_LOG_N};
+}
+
+static void register_vqsort_algos (SortAlgoMap<double>& sort_algos)
+{
+    sort_algos["vqsort"] = SortAlgoInfo<double>{vqsort_sort<double>, COMPLEXITY_N_LOG_N};
+}
+#endif
+
+template <typename T>
+static void register_vqsort_algos (SortAlgoMap<T>& sort_algos)
+{
+    (void) sort_algos;
+}
+
+/*
+ * Fill the given map with every sorting algorithm that applies to elements
+ * of type T, each instantiated with the default comparator.
+ */
+template <typename T>
+void register_sort_algos (SortAlgoMap<T>& sort_algos)
+{
+    using Info = SortAlgoInfo<T>;
+    using Less = std::less<T>;
+
+    sort_algos["Insertion Sort"] = Info{[] (T *v, int n) {
+        insertion_sort(v, n, Less()); }, COMPLEXITY_QUADRATIC};
+    sort_algos["Selection Sort"] = Info{[] (T *v, int n) {
+        selection_sort(v, n, Less()); }, COMPLEXITY_QUADRATIC};
+    sort_algos["Bubble Sort"] = Info{[] (T *v, int n) {
+        bubble_sort(v, n, Less()); }, COMPLEXITY_QUADRATIC};
+    sort_algos["Heap Sort"] = Info{[] (T *v, int n) {
+        heap_sort(v, n, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Heap Sort (hole)"] = Info{[] (T *v, int n) {
+        d_ary_heap_sort<2>(v, n, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Heap Sort (4-ary)"] = Info{[] (T *v, int n) {
+        d_ary_heap_sort<4>(v, n, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Heap Sort (8-ary)"] = Info{[] (T *v, int n) {
+        d_ary_heap_sort<8>(v, n, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Heap Sort (bottom-up)"] = Info{[] (T *v, int n) {
+        bottom_up_heap_sort(v, n, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Merge Sort"] = Info{[] (T *v, int n) {
+        merge_sort(v, n, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["TimSort"] = Info{[] (T *v, int n) {
+        adaptive_merge_sort(v, n, POLICY_TIMSORT, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Powersort"] = Info{[] (T *v, int n) {
+        adaptive_merge_sort(v, n, POLICY_POWERSORT, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Quick Sort"] = Info{[] (T *v, int n) {
+        quick_sort(v, n, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Quick Sort (pdq)"] = Info{[] (T *v, int n) {
+        pdq_sort(v, n, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Quick Sort (naive)"] = Info{[] (T *v, int n) {
+        naive_quick_sort(v, n, Less()); }, COMPLEXITY_QUADRATIC};
+    sort_algos["Shell Sort"] = Info{[] (T *v, int n) {
+        shell_sort(v, n, Less()); }, COMPLEXITY_QUADRATIC};
+    sort_algos["Shell Sort (Shell)"] = Info{[] (T *v, int n) {
+        gapped_shell_sort(v, n, GAPS_SHELL, Less()); }, COMPLEXITY_QUADRATIC};
+    sort_algos["Shell Sort (Knuth)"] = Info{[] (T *v, int n) {
+        gapped_shell_sort(v, n, GAPS_KNUTH, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Shell Sort (Sedgewick)"] = Info{[] (T *v, int n) {
+        gapped_shell_sort(v, n, GAPS_SEDGEWICK, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Shell Sort (Tokuda)"] = Info{[] (T *v, int n) {
+        gapped_shell_sort(v, n, GAPS_TOKUDA, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Shell Sort (Ciura)"] = Info{[] (T *v, int n) {
+        gapped_shell_sort(v, n, GAPS_CIURA, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Shell Sort (Pratt)"] = Info{[] (T *v, int n) {
+        gapped_shell_sort(v, n, GAPS_PRATT, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["Merge Sort (parallel)"] = Info{[] (T *v, int n) {
+        parallel_merge_sort(v, n, Less()); }, COMPLEXITY_N_LOG_N, true};
+    sort_algos["Quick Sort (parallel)"] = Info{[] (T *v, int n) {
+        parallel_quick_sort(v, n, Less()); }, COMPLEXITY_N_LOG_N, true};
+    sort_algos["Radix Sort (LSD)"] = Info{lsd_radix_sort<T>, COMPLEXITY_LINEAR};
+    sort_algos["Radix Sort (MSD)"] = Info{msd_radix_sort<T>, COMPLEXITY_LINEAR};
+    sort_algos["std::sort"] = Info{[] (T *v, int n) {
+        std::sort(v, v + n, Less()); }, COMPLEXITY_N_LOG_N};
+    sort_algos["std::stable_sort"] = Info{[] (T *v, int n) {
+        std::stable_sort(v, v + n, Less()); }, COMPLEXITY_N_LOG_N};
+
+    register_integer_algos(sort_algos);
+    register_wide_algos(sort_algos);
+    register_library_algos(sort_algos);
+    register_vqsort_algos(sort_algos);
+}
+
+/*
+ * Fill the given map with every top-k and selection algorithm, each
+ * instantiated for elements of type T with the default comparator, beside
+ * the standard library's partial_sort() and nth_element() to compare them
+ * with.
+ */
+template <typename T>
+void register_select_algos (SortAlgoMap<T>& select_algos)
+{
+    using Info = SortAlgoInfo<T>;
+    using Less = std::less<T>;
+
+    select_algos["Top-k (heap)"] = Info{NULL, COMPLEXITY_N_LOG_N, false,
+        [] (T *v, int n, int k) { heap_top_k(v, n, k, Less()); }, KIND_TOP_K};
+    select_algos["Top-k (partial Quick Sort)"] = Info{NULL, COMPLEXITY_N_LOG_N, false,
+        [] (T *v, int n, int k) { partial_quick_sort(v, n, k, Less()); }, KIND_TOP_K};
+    select_algos["Top-k (std::partial_sort)"] = Info{NULL, COMPLEXITY_N_LOG_N, false,
+        [] (T *v, int n, int k) { std::partial_sort(v, v + k, v + n, Less()); },
+        KIND_TOP_K};
+    select_algos["Select (introselect)"] = Info{NULL, COMPLEXITY_LINEAR, false,
+        [] (T *v, int n, int k) { intro_select(v, n, k, Less()); }, KIND_SELECT};
+    select_algos["Select (Floyd-Rivest)"] = Info{NULL, COMPLEXITY_LINEAR, false,
+        [] (T *v, int n, int k) { floyd_rivest_select(v, n, k, Less()); }, KIND_SELECT};
+    select_algos["Select (std::nth_element)"] = Info{NULL, COMPLEXITY_LINEAR, false,
+        [] (T *v, int n, int k) { std::nth_element(v, v + k - 1, v + n, Less()); },
+        KIND_SELECT};
+}
+
+/*
+ * Parse the given element type name into type, returning whether it names
+ * one of the element types.
+ */
+bool parse_element_type (const char *name, ElementType& type)
+{
+    const int num_types = sizeof(element_type_names) / sizeof(element_type_names[0]);
+
+    for (int i = 0; i < num_types; ++i) {
+        if (!strcmp(name, element_type_names[i])) {
+            type = (ElementType) i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Return the name of the given element type, as accepted by --type.
+ */
+const char *element_type_name (ElementType type)
+{
+    return element_type_names[type];
+}
+
+#define INSTANTIATE_REGISTRY(T) \
+    template void register_sort_algos<T> (SortAlgoMap<T>& sort_algos); \
+    template void register_select_algos<T> (SortAlgoMap<T>& select_algos);
+
+FOR_EACH_ELEMENT_TYPE(INSTANTIATE_REGISTRY)
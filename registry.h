@@ -0,0 +1,33 @@
+/**
+ * The registry of sorting algorithms. register_sort_algos() instantiates
+ * every algorithm that applies to an element type with that type and the
+ * default comparator, so that each registered function has its comparisons
+ * inlined, and records it under its display name. The instantiations for
+ * all element types are compiled in registry.cc, and the element type to
+ * benchmark is chosen at run time with --type. register_select_algos()
+ * likewise records the top-k and selection algorithms, which take a rank
+ * k and are measured instead of the sorts when --k is given.
+ */
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+/* include statements */
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include "benchmark.h"
+#include "elementtypes.h"
+
+/* using declarations */
+template <typename T>
+using SortAlgoMap = std::unordered_map<std::string, SortAlgoInfo<T> >;
+
+/* function declarations */
+template <typename T> void register_sort_algos (SortAlgoMap<T>& sort_algos);
+template <typename T> void register_select_algos (SortAlgoMap<T>& select_algos);
+bool parse_element_type (const char *name, ElementType& type);
+const char *element_type_name (ElementType type);
+
+#endif // REGISTRY_H
@@ -0,0 +1,305 @@
+/**
+ * Comparison of a run against a baseline, for catching regressions. The
+ * baseline is a result export written earlier with --format csv or json,
+ * whose trials are grouped by algorithm and dataset. Each cell of the
+ * current run that has a baseline cell on a dataset of the same size is
+ * given a Mann-Whitney U test on the two sets of trial times, using the
+ * normal approximation with a correction for ties, and a Hodges-Lehmann
+ * estimate of the ratio of the two times: the median of the ratios of
+ * every current trial to every baseline trial, with a distribution-free 95%
+ * confidence interval taken from the same ratios. A cell has regressed when
+ * the test is significant and the estimated slowdown exceeds the threshold.
+ */
+
+#include "regression.h"
+
+/*
+ * Load the trials of the result export at the given path into baseline,
+ * keyed by algorithm and dataset. Records of skipped cells, which have no
+ * time, are ignored. Return false, after notifying the user, if the file
+ * cannot be read or is not an export.
+ */
+bool load_baseline (const char *path, BaselineMap& baseline)
+{
+    std::ifstream file(path);          /* The export being loaded */
+    std::string line;                  /* Current line of the export */
+    std::vector<std::string> fields;   /* Fields of the current CSV row */
+    int algo_col = -1;                 /* Columns of the fields that are used */
+    int dataset_col = -1;
+    int size_col = -1;
+    int time_col = -1;
+
+    if (!file) {
+        std::cerr << "ERROR: Failed to open baseline file " << path << std::endl;
+        return false;
+    }
+
+    if (!std::getline(file, line)) {
+        std::cerr << "ERROR: Baseline file " << path << " is empty" << std::endl;
+        return false;
+    }
+
+    /* A CSV export starts with its header row, and a JSON export with the
+     * first of its objects. */
+    bool json = !line.empty() && line[0] == '{';
+
+    if (!json) {
+        parse_csv_line(line, fields);
+
+        for (int i = 0; i < (int) fields.size(); ++i) {
+            if (fields[i] == "algorithm")
+                algo_col = i;
+            else if (fields[i] == "dataset")
+                dataset_col = i;
+            else if (fields[i] == "size")
+                size_col = i;
+            else if (fields[i] == "time_ns")
+                time_col = i;
+        }
+
+        if (algo_col < 0 || dataset_col < 0 || size_col < 0 || time_col < 0) {
+            std::cerr << "ERROR: Baseline file " << path
+                << " is not a CSV or JSON result export" << std::endl;
+            return false;
+        }
+
+        if (!std::getline(file, line))
+            return true;
+    }
+
+    do {
+        std::string algo, dataset, size, time;
+
+        if (line.empty())
+            continue;
+
+        if (json) {
+            if (!find_json_value(line, "algorithm", algo) ||
+                    !find_json_value(line, "dataset", dataset) ||
+                    !find_json_value(line, "size", size) ||
+                    !find_json_value(line, "time_ns", time)) {
+                std::cerr << "ERROR: Malformed record in baseline file " << path
+                    << std::endl;
+                return false;
+            }
+        } else {
+            if (!parse_csv_line(line, fields) || (int) fields.size() <= time_col ||
+                    (int) fields.size() <= algo_col || (int) fields.size() <= dataset_col ||
+                    (int) fields.size() <= size_col) {
+                std::cerr << "ERROR: Malformed row in baseline file " << path << std::endl;
+                return false;
+            }
+
+            algo = fields[algo_col];
+            dataset = fields[dataset_col];
+            size = fields[size_col];
+            time = fields[time_col];
+        }
+
+        if (time.empty() || time == "null")
+            continue;
+
+        BaselineCell& cell = baseline[baseline_key(algo, std::atoi(dataset.c_str()))];
+        cell.size = std::atoi(size.c_str());
+        cell.samples.push_back(std::atoll(time.c_str()));
+    } while (std::getline(file, line));
+
+    return true;
+}
+
+/*
+ * Split the given CSV line into fields, undoing the quoting of any quoted
+ * field. Return false if a quoted field is not terminated.
+ */
+bool parse_csv_line (const std::string& line, std::vector<std::string>& fields)
+{
+    std::string field;  /* Field being read */
+    std::size_t i = 0;  /* Index of the next character of the line */
+
+    fields.clear();
+
+    while (true) {
+        field.clear();
+
+        if (i < line.size() && line[i] == '"') {
+            for (++i; ; ++i) {
+                if (i >= line.size())
+                    return false;
+
+                if (line[i] == '"') {
+                    if (i + 1 < line.size() && line[i + 1] == '"')
+                        ++i;
+                    else
+                        break;
+                }
+
+                field += line[i];
+            }
+
+            ++i;
+        } else {
+            while (i < line.size() && line[i] != ',' && line[i] != '\r')
+                field += line[i++];
+        }
+
+        fields.push_back(field);
+
+        if (i >= line.size() || line[i] != ',')
+            return true;
+
+        ++i;
+    }
+}
+
+/*
+ * Find the value of the given key in a line of a JSON export, which holds
+ * one flat object. Strings are unescaped, and numbers and null are returned
+ * as written. Return whether the key was found.
+ */
+bool find_json_value (const std::string& line, const char *key, std::string& value)
+{
+    std::string quoted = std::string("\"") + key + "\":";
+    std::size_t pos = line.find(quoted);
+
+    if (pos == std::string::npos)
+        return false;
+
+    pos = line.find_first_not_of(" ", pos + quoted.size());
+    if (pos == std::string::npos)
+        return false;
+
+    value.clear();
+
+    if (line[pos] != '"') {
+        std::size_t end = line.find_first_of(",}", pos);
+        value = line.substr(pos, end == std::string::npos ? end : end - pos);
+        return true;
+    }
+
+    for (++pos; pos < line.size() && line[pos] != '"'; ++pos) {
+        if (line[pos] == '\\' && pos + 1 < line.size()) {
+            ++pos;
+
+            if (line[pos] == 'u' && pos + 4 < line.size()) {
+                value += (char) std::strtol(line.substr(pos + 1, 4).c_str(), NULL, 16);
+                pos += 4;
+                continue;
+            }
+        }
+
+        value += line[pos];
+    }
+
+    return pos < line.size();
+}
+
+/*
+ * Return the key of the given algorithm's cell on the given dataset.
+ */
+std::string baseline_key (const std::string& algo, int dataset)
+{
+    return algo + '\t' + std::to_string(dataset);
+}
+
+/*
+ * Compare the trial times of a cell with those of its baseline cell into
+ * comparison. The ratio is the Hodges-Lehmann estimate, the median of the
+ * ratios of every current trial to every baseline trial, and its confidence
+ * interval runs between the order statistics of those ratios given by the
+ * normal approximation to the distribution of the U statistic. The cell has
+ * regressed if the test is significant and the ratio exceeds 1 + threshold.
+ */
+void compare_with_baseline (const std::vector<long long>& baseline,
+    const std::vector<long long>& current, double threshold,
+    BaselineComparison& comparison)
+{
+    const int m = baseline.size();
+    const int n = current.size();
+    std::vector<double> ratios;  /* Every current trial over every baseline trial */
+    double k;                    /* Rank of the lower end of the interval */
+
+    comparison.tested = false;
+    comparison.regressed = false;
+    comparison.ratio = comparison.ratio_lo = comparison.ratio_hi = 1;
+    comparison.p_value = 1;
+
+    if (m == 0 || n == 0)
+        return;
+
+    ratios.reserve((std::size_t) m * n);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < m; ++j)
+            ratios.push_back((double) current[i] / std::max(baseline[j], 1LL));
+
+    std::sort(ratios.begin(), ratios.end());
+
+    const int count = ratios.size();
+    comparison.ratio = count % 2 ? ratios[count / 2] :
+        std::sqrt(ratios[count / 2 - 1] * ratios[count / 2]);
+
+    if (m < BASELINE_MIN_TRIALS || n < BASELINE_MIN_TRIALS) {
+        comparison.ratio_lo = ratios.front();
+        comparison.ratio_hi = ratios.back();
+        return;
+    }
+
+    k = std::floor((double) m * n / 2 -
+        BASELINE_Z * std::sqrt((double) m * n * (m + n + 1) / 12));
+    k = std::max(k, 0.0);
+
+    comparison.tested = true;
+    comparison.ratio_lo = ratios[(int) k];
+    comparison.ratio_hi = ratios[count - 1 - (int) k];
+    comparison.p_value = mann_whitney_p_value(baseline, current);
+    comparison.regressed = comparison.p_value < BASELINE_ALPHA &&
+        comparison.ratio > 1 + threshold;
+}
+
+/*
+ * Return the two-sided p-value of the Mann-Whitney U test of whether the
+ * given samples come from the same distribution, using the normal
+ * approximation with a continuity correction and a correction for ties.
+ */
+double mann_whitney_p_value (const std::vector<long long>& a,
+    const std::vector<long long>& b)
+{
+    const double m = a.size();
+    const double n = b.size();
+    std::vector<std::pair<long long, int> > pooled;  /* Samples with their group */
+    double rank_sum = 0;   /* Sum of the ranks of the samples of a */
+    double tie_sum = 0;    /* Sum of t^3 - t over each run of t tied samples */
+
+    for (std::size_t i = 0; i < a.size(); ++i)
+        pooled.emplace_back(a[i], 0);
+    for (std::size_t i = 0; i < b.size(); ++i)
+        pooled.emplace_back(b[i], 1);
+
+    std::sort(pooled.begin(), pooled.end());
+
+    /* Give each run of tied samples the mean of the ranks it spans */
+    for (std::size_t i = 0; i < pooled.size(); ) {
+        std::size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first)
+            ++j;
+
+        double t = j - i;
+        double mid_rank = (i + 1 + j) / 2.0;
+
+        for (std::size_t r = i; r < j; ++r)
+            if (pooled[r].second == 0)
+                rank_sum += mid_rank;
+
+        tie_sum += t * t * t - t;
+        i = j;
+    }
+
+    double u = rank_sum - m * (m + 1) / 2;
+    double mean = m * n / 2;
+    double variance = m * n / 12 * ((m + n + 1) - tie_sum / ((m + n) * (m + n - 1)));
+
+    if (variance <= 0)
+        return 1;
+
+    double z = std::max(std::fabs(u - mean) - 0.5, 0.0) / std::sqrt(variance);
+    return std::erfc(z / std::sqrt(2.0));
+}
@@ -0,0 +1,64 @@
+/**
+ * Comparison of a run against a baseline, for catching regressions. The
+ * baseline is a result export written earlier with --format csv or json,
+ * whose trials are grouped by algorithm and dataset. Each cell of the
+ * current run that has a baseline cell on a dataset of the same size is
+ * given a Mann-Whitney U test on the two sets of trial times, using the
+ * normal approximation with a correction for ties, and a Hodges-Lehmann
+ * estimate of the ratio of the two times: the median of the ratios of
+ * every current trial to every baseline trial, with a distribution-free 95%
+ * confidence interval taken from the same ratios. A cell has regressed when
+ * the test is significant and the estimated slowdown exceeds the threshold.
+ */
+
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+/* include statements */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* The trial times of one baseline cell */
+struct BaselineCell {
+    int size;                        /* Length of the dataset */
+    std::vector<long long> samples;  /* Trial times in nanoseconds */
+};
+
+/* using declarations */
+using BaselineMap = std::unordered_map<std::string, BaselineCell>;
+
+/* The outcome of comparing a cell with its baseline */
+struct BaselineComparison {
+    bool tested;      /* Whether both cells had enough trials to be tested */
+    double ratio;     /* Estimated current time over baseline time */
+    double ratio_lo;  /* Lower end of the 95% confidence interval of ratio */
+    double ratio_hi;  /* Upper end of the 95% confidence interval of ratio */
+    double p_value;   /* Two-sided p-value of the Mann-Whitney U test */
+    bool regressed;   /* Significantly slower by more than the threshold */
+};
+
+/* constants */
+const double BASELINE_ALPHA = 0.05;      /* Significance level of the test */
+const double BASELINE_Z = 1.959964;      /* Normal quantile of the 95% interval */
+/* Fewest trials each cell needs to be tested: with 3 on either side, the
+ * test cannot reach p < BASELINE_ALPHA however far apart the samples are */
+const int BASELINE_MIN_TRIALS = 4;
+
+/* function declarations */
+bool load_baseline (const char *path, BaselineMap& baseline);
+bool parse_csv_line (const std::string& line, std::vector<std::string>& fields);
+bool find_json_value (const std::string& line, const char *key, std::string& value);
+std::string baseline_key (const std::string& algo, int dataset);
+void compare_with_baseline (const std::vector<long long>& baseline,
+    const std::vector<long long>& current, double threshold,
+    BaselineComparison& comparison);
+double mann_whitney_p_value (const std::vector<long long>& a,
+    const std::vector<long long>& b);
+
+#endif // REGRESSION_H
@@ -0,0 +1,240 @@
+/**
+ * Machine-readable export of every measurement, for dashboards and scripts.
+ * With --format csv or --format json, one record is written per timed trial
+ * of every (algorithm, dataset) cell, plus one record for each cell that
+ * was skipped, as soon as the cell has been measured. Every record carries
+ * the metadata of the run it came from: the git revision and compiler flags
+ * the program was built with, the CPU model, the number of threads and the
+ * element type. CSV output starts with a header row, and JSON output holds
+ * one object per line, so that both can be read while the run is still in
+ * progress.
+ */
+
+#include "resultexport.h"
+
+/* The build facts the Makefile passes in, if it did */
+#ifndef SORTCOMPARER_REVISION
+#define SORTCOMPARER_REVISION "unknown"
+#endif
+
+#ifndef SORTCOMPARER_FLAGS
+#define SORTCOMPARER_FLAGS "unknown"
+#endif
+
+/*
+ * Start streaming records in the given format to the file at the given
+ * path, or to stdout if it is NULL, writing the CSV header row if needed.
+ * Return false, after notifying the user, if the file cannot be created.
+ */
+bool open_exporter (ResultExporter& exporter, OutputFormat format,
+    const char *path, const RunMetadata& metadata)
+{
+    exporter.format = format;
+    exporter.metadata = metadata;
+    exporter.out = &std::cout;
+
+    if (path) {
+        exporter.file.open(path);
+
+        if (!exporter.file) {
+            std::cerr << "ERROR: Failed to create output file " << path << std::endl;
+            return false;
+        }
+
+        exporter.out = &exporter.file;
+    }
+
+    if (format == FORMAT_CSV)
+        *exporter.out << "revision,compiler,flags,cpu,threads,element_type,"
+            "algorithm,dataset,label,size,trial,time_ns,status" << std::endl;
+
+    return true;
+}
+
+/*
+ * Write the records of one measured cell: one per timed trial in the order
+ * the trials ran, or a single record without a time if no trial ran. The
+ * records are flushed, so readers see each cell as soon as it completes.
+ */
+void export_cell (ResultExporter& exporter, const std::string& algo, int dataset,
+    const std::string& label, int size, const CellResult& cell,
+    const std::vector<long long>& samples)
+{
+    const RunMetadata& meta = exporter.metadata;
+    std::ostream& out = *exporter.out;
+    const int num_records = std::max((int) samples.size(), 1);
+
+    for (int trial = 0; trial < num_records; ++trial) {
+        std::string time = trial < (int) samples.size() ?
+            std::to_string(samples[trial]) : "";
+
+        if (exporter.format == FORMAT_CSV) {
+            out << csv_field(meta.revision) << ',' << csv_field(meta.compiler) << ','
+                << csv_field(meta.flags) << ',' << csv_field(meta.cpu_model) << ','
+                << meta.threads << ',' << meta.element_type << ',' << csv_field(algo)
+                << ',' << dataset << ',' << csv_field(label) << ',' << size << ','
+                << (samples.empty() ? "" : std::to_string(trial + 1)) << ',' << time
+                << ',' << cell_status_name(cell.status) << '\n';
+        } else {
+            out << "{\"revision\": " << json_string(meta.revision)
+                << ", \"compiler\": " << json_string(meta.compiler)
+                << ", \"flags\": " << json_string(meta.flags)
+                << ", \"cpu\": " << json_string(meta.cpu_model)
+                << ", \"threads\": " << meta.threads
+                << ", \"element_type\": " << json_string(meta.element_type)
+                << ", \"algorithm\": " << json_string(algo)
+                << ", \"dataset\": " << dataset
+                << ", \"label\": " << json_string(label)
+                << ", \"size\": " << size
+                << ", \"trial\": " << (samples.empty() ? "null" : std::to_string(trial + 1))
+                << ", \"time_ns\": " << (time.empty() ? "null" : time)
+                << ", \"status\": \"" << cell_status_name(cell.status) << "\"}\n";
+        }
+    }
+
+    out.flush();
+}
+
+/*
+ * Finish writing records and close the output file, if there is one.
+ */
+void close_exporter (ResultExporter& exporter)
+{
+    exporter.out->flush();
+
+    if (exporter.file.is_open())
+        exporter.file.close();
+}
+
+/*
+ * Fill in the metadata of the current run.
+ */
+void collect_run_metadata (RunMetadata& metadata, int threads, const char *element_type)
+{
+    metadata.revision = SORTCOMPARER_REVISION;
+#if defined(__GNUC__) && !defined(__clang__)
+    metadata.compiler = "GCC " __VERSION__;
+#elif defined(__VERSION__)
+    metadata.compiler = __VERSION__;
+#else
+    metadata.compiler = "unknown";
+#endif
+    metadata.flags = SORTCOMPARER_FLAGS;
+    metadata.cpu_model = read_cpu_model();
+    metadata.threads = threads;
+    metadata.element_type = element_type;
+}
+
+/*
+ * Parse the given output format name into format, returning whether it
+ * names one of the formats.
+ */
+bool parse_output_format (const char *name, OutputFormat& format)
+{
+    std::string str(name);
+
+    if (str == "text")
+        format = FORMAT_TEXT;
+    else if (str == "csv")
+        format = FORMAT_CSV;
+    else if (str == "json")
+        format = FORMAT_JSON;
+    else
+        return false;
+
+    return true;
+}
+
+/*
+ * Return the model name of the CPU from /proc/cpuinfo, or "unknown" where
+ * that is not available.
+ */
+std::string read_cpu_model ()
+{
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") != 0)
+            continue;
+
+        std::size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            break;
+
+        std::size_t start = line.find_first_not_of(" \t", colon + 1);
+        return start == std::string::npos ? "unknown" : line.substr(start);
+    }
+
+    return "unknown";
+}
+
+/*
+ * Return the given string as a CSV field, quoted if it holds a comma, a
+ * quote or a line break, with any quotes doubled.
+ */
+std::string csv_field (const std::string& str)
+{
+    std::string field;
+
+    if (str.find_first_of(",\"\r\n") == std::string::npos)
+        return str;
+
+    field = "\"";
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        if (str[i] == '"')
+            field += '"';
+        field += str[i];
+    }
+    field += '"';
+
+    return field;
+}
+
+/*
+ * Return the given string as a quoted JSON string, escaping the characters
+ * JSON requires.
+ */
+std::string json_string (const std::string& str)
+{
+    std::string quoted = "\"";
+
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        unsigned char c = str[i];
+
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (c < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+            quoted += escape;
+        } else {
+            quoted += c;
+        }
+    }
+
+    return quoted + "\"";
+}
+
+/*
+ * Return the name of the given cell status, as written in each record.
+ */
+const char *cell_status_name (CellStatus status)
+{
+    switch (status) {
+    case CELL_MEASURED:
+        return "measured";
+    case CELL_SKIPPED_SIZE:
+        return "skipped_size";
+    case CELL_SKIPPED_ESTIMATE:
+        return "skipped_estimate";
+    case CELL_UNSORTED:
+        return "unsorted";
+    case CELL_CORRUPTED:
+        return "corrupted";
+    case CELL_ABORTED:
+    default:
+        return "aborted";
+    }
+}
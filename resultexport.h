@@ -0,0 +1,65 @@
+/**
+ * Machine-readable export of every measurement, for dashboards and scripts.
+ * With --format csv or --format json, one record is written per timed trial
+ * of every (algorithm, dataset) cell, plus one record for each cell that
+ * was skipped, as soon as the cell has been measured. Every record carries
+ * the metadata of the run it came from: the git revision and compiler flags
+ * the program was built with, the CPU model, the number of threads and the
+ * element type. CSV output starts with a header row, and JSON output holds
+ * one object per line, so that both can be read while the run is still in
+ * progress.
+ */
+
+#ifndef RESULTEXPORT_H
+#define RESULTEXPORT_H
+
+/* include statements */
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+
+/* The formats results can be printed in */
+enum OutputFormat {
+    FORMAT_TEXT,   /* SUMMARY and RESULTS sections for people */
+    FORMAT_CSV,    /* One comma-separated row per measurement */
+    FORMAT_JSON    /* One JSON object per line per measurement */
+};
+
+/* Facts about the build and the machine, written with every record */
+struct RunMetadata {
+    std::string revision;      /* Git revision the program was built from */
+    std::string compiler;      /* Compiler name and version */
+    std::string flags;         /* Compiler flags the program was built with */
+    std::string cpu_model;     /* Model name of the CPU */
+    int threads;               /* Threads in the pool used by parallel sorts */
+    std::string element_type;  /* Type of the elements being sorted */
+};
+
+/* A destination that measurements are streamed to */
+struct ResultExporter {
+    OutputFormat format;       /* FORMAT_CSV or FORMAT_JSON */
+    std::ofstream file;        /* The output file, if one was given */
+    std::ostream *out;         /* The file, or stdout */
+    RunMetadata metadata;      /* Written with every record */
+};
+
+/* function declarations */
+bool open_exporter (ResultExporter& exporter, OutputFormat format,
+    const char *path, const RunMetadata& metadata);
+void export_cell (ResultExporter& exporter, const std::string& algo, int dataset,
+    const std::string& label, int size, const CellResult& cell,
+    const std::vector<long long>& samples);
+void close_exporter (ResultExporter& exporter);
+void collect_run_metadata (RunMetadata& metadata, int threads, const char *element_type);
+bool parse_output_format (const char *name, OutputFormat& format);
+std::string read_cpu_model ();
+std::string csv_field (const std::string& str);
+std::string json_string (const std::string& str);
+const char *cell_status_name (CellStatus status);
+
+#endif // RESULTEXPORT_H
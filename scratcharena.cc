@@ -0,0 +1,164 @@
+/**
+ * A harness-owned arena for the scratch memory of the sorting algorithms,
+ * so that no timed run calls malloc or takes a page fault on memory it
+ * touches for the first time. Each thread that measures cells creates an
+ * arena once, sized for its largest dataset, and installs it as the
+ * thread's current arena. The arena is mapped with huge pages when the
+ * system has some reserved, and otherwise asks for transparent huge pages,
+ * and every page is written as soon as it is mapped.
+ *
+ * Algorithms allocate their buffers as ScratchVectors, whose allocator
+ * bumps a pointer in the current arena and rewinds it when the most recent
+ * buffer is freed, and the harness resets the arena before every run.
+ * Allocations that do not fit in the arena fall back to the heap, and are
+ * counted so that the harness can warn about them, while threads without an
+ * arena, such as the workers of the thread pool, always use the heap.
+ */
+
+#include "scratcharena.h"
+
+/* The arena of the calling thread, or NULL */
+static thread_local ScratchArena *thread_arena = NULL;
+
+/* Names of the page backings, indexed by ArenaPages */
+static const char *arena_pages_names[] = {"huge pages", "transparent huge pages",
+    "normal pages"};
+
+/*
+ * Map an arena of at least the given number of bytes, rounded up to whole
+ * huge pages, and write to every page of it so that none faults later.
+ * Return whether it could be mapped, after warning the user if not.
+ */
+bool create_scratch_arena (ScratchArena& arena, std::size_t bytes)
+{
+    const long page_bytes = sysconf(_SC_PAGESIZE);  /* Size of an ordinary page */
+    void *p = MAP_FAILED;                           /* Start of the mapping */
+
+    arena = ScratchArena{NULL, 0, 0, 0, ARENA_PAGES_NORMAL, 0};
+    bytes = (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+
+#ifdef MAP_HUGETLB
+    p = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED)
+        arena.pages = ARENA_PAGES_HUGETLB;
+#endif
+
+    if (p == MAP_FAILED) {
+        p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (p == MAP_FAILED) {
+            std::cerr << "WARNING: Failed to map a scratch arena of " << bytes
+                << " bytes: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+#ifdef MADV_HUGEPAGE
+        if (madvise(p, bytes, MADV_HUGEPAGE) == 0)
+            arena.pages = ARENA_PAGES_TRANSPARENT;
+#endif
+    }
+
+    arena.base = static_cast<char *>(p);
+    arena.capacity = bytes;
+
+    for (std::size_t offset = 0; offset < bytes; offset += page_bytes)
+        arena.base[offset] = 0;
+
+    return true;
+}
+
+/*
+ * Unmap the given arena, which must no longer be current on any thread.
+ */
+void destroy_scratch_arena (ScratchArena& arena)
+{
+    if (arena.base)
+        munmap(arena.base, arena.capacity);
+
+    arena.base = NULL;
+    arena.capacity = arena.used = 0;
+}
+
+/*
+ * Return the given number of bytes from the top of the arena, aligned to
+ * ARENA_ALIGNMENT, or NULL if there is no room left for them.
+ */
+void *arena_allocate (ScratchArena& arena, std::size_t bytes)
+{
+    bytes = (bytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+
+    if (bytes > arena.capacity - arena.used) {
+        ++arena.overflows;
+        return NULL;
+    }
+
+    void *p = arena.base + arena.used;
+
+    arena.used += bytes;
+    arena.peak = std::max(arena.peak, arena.used);
+    return p;
+}
+
+/*
+ * Give back an allocation of the given number of bytes, rewinding the arena
+ * if it is the most recent one still held. Return whether the allocation
+ * came from the arena at all.
+ */
+bool arena_deallocate (ScratchArena& arena, void *p, std::size_t bytes)
+{
+    char *start = static_cast<char *>(p);  /* First byte of the allocation */
+
+    if (start < arena.base || start >= arena.base + arena.capacity)
+        return false;
+
+    bytes = (bytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+
+    if (start + bytes == arena.base + arena.used)
+        arena.used = start - arena.base;
+
+    return true;
+}
+
+/*
+ * Forget every allocation of the arena, which must no longer be in use.
+ */
+void reset_scratch_arena (ScratchArena& arena)
+{
+    arena.used = 0;
+}
+
+/*
+ * Return the size of arena to create for datasets of up to the given number
+ * of bytes: enough for an auxiliary copy of the dataset and the buffers
+ * that grow as an adaptive merge proceeds, plus room for small buffers.
+ */
+std::size_t scratch_arena_bytes (std::size_t dataset_bytes)
+{
+    return 2 * dataset_bytes + ARENA_SLACK_BYTES;
+}
+
+/*
+ * Make the given arena, or none if it is NULL, the current arena of the
+ * calling thread, from which the ScratchVectors it creates allocate.
+ */
+void use_scratch_arena (ScratchArena *arena)
+{
+    thread_arena = arena;
+}
+
+/*
+ * Return the current arena of the calling thread, or NULL if it has none.
+ */
+ScratchArena *current_scratch_arena ()
+{
+    return thread_arena;
+}
+
+/*
+ * Return a description of the given page backing.
+ */
+const char *arena_pages_name (ArenaPages pages)
+{
+    return arena_pages_names[pages];
+}
@@ -0,0 +1,109 @@
+/**
+ * A harness-owned arena for the scratch memory of the sorting algorithms,
+ * so that no timed run calls malloc or takes a page fault on memory it
+ * touches for the first time. Each thread that measures cells creates an
+ * arena once, sized for its largest dataset, and installs it as the
+ * thread's current arena. The arena is mapped with huge pages when the
+ * system has some reserved, and otherwise asks for transparent huge pages,
+ * and every page is written as soon as it is mapped.
+ *
+ * Algorithms allocate their buffers as ScratchVectors, whose allocator
+ * bumps a pointer in the current arena and rewinds it when the most recent
+ * buffer is freed, and the harness resets the arena before every run.
+ * Allocations that do not fit in the arena fall back to the heap, and are
+ * counted so that the harness can warn about them, while threads without an
+ * arena, such as the workers of the thread pool, always use the heap.
+ */
+
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+/* include statements */
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* How the pages of an arena are backed */
+enum ArenaPages {
+    ARENA_PAGES_HUGETLB,      /* Reserved huge pages */
+    ARENA_PAGES_TRANSPARENT,  /* Ordinary pages the kernel was asked to merge */
+    ARENA_PAGES_NORMAL        /* Ordinary pages */
+};
+
+/* A region of pre-faulted memory handed out from the bottom up */
+struct ScratchArena {
+    char *base;            /* Start of the mapping, or NULL if none */
+    std::size_t capacity;  /* Bytes mapped */
+    std::size_t used;      /* Bytes handed out below the next allocation */
+    std::size_t peak;      /* Most bytes handed out at once */
+    ArenaPages pages;      /* How the mapping is backed */
+    long long overflows;   /* Allocations that did not fit and went to the heap */
+};
+
+/* constants */
+const std::size_t ARENA_ALIGNMENT = 64;              /* Alignment of every allocation */
+const std::size_t ARENA_SLACK_BYTES = 1 << 22;       /* Room for small buffers */
+const std::size_t HUGE_PAGE_BYTES = 1 << 21;         /* Size of a huge page */
+
+/* function declarations */
+bool create_scratch_arena (ScratchArena& arena, std::size_t bytes);
+void destroy_scratch_arena (ScratchArena& arena);
+void *arena_allocate (ScratchArena& arena, std::size_t bytes);
+bool arena_deallocate (ScratchArena& arena, void *p, std::size_t bytes);
+void reset_scratch_arena (ScratchArena& arena);
+std::size_t scratch_arena_bytes (std::size_t dataset_bytes);
+void use_scratch_arena (ScratchArena *arena);
+ScratchArena *current_scratch_arena ();
+const char *arena_pages_name (ArenaPages pages);
+
+/* A standard allocator drawing from the arena current on the thread that
+ * created it, or from the heap if there was none */
+template <typename T>
+struct ScratchAllocator {
+    using value_type = T;
+
+    ScratchArena *arena;  /* Arena allocations come from, or NULL */
+
+    ScratchAllocator () : arena(current_scratch_arena()) {}
+
+    template <typename U>
+    ScratchAllocator (const ScratchAllocator<U>& other) : arena(other.arena) {}
+
+    T *allocate (std::size_t n)
+    {
+        void *p = arena ? arena_allocate(*arena, n * sizeof(T)) : NULL;
+
+        return static_cast<T *>(p ? p : ::operator new(n * sizeof(T)));
+    }
+
+    void deallocate (T *p, std::size_t n)
+    {
+        if (!arena || !arena_deallocate(*arena, p, n * sizeof(T)))
+            ::operator delete(p);
+    }
+};
+
+template <typename T, typename U>
+bool operator== (const ScratchAllocator<T>& a, const ScratchAllocator<U>& b)
+{
+    return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+bool operator!= (const ScratchAllocator<T>& a, const ScratchAllocator<U>& b)
+{
+    return a.arena != b.arena;
+}
+
+/* using declarations */
+template <typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T> >;
+
+#endif // SCRATCHARENA_H
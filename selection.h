@@ -0,0 +1,279 @@
+/**
+ * Partial sorting and selection, for when only the smallest k elements of a
+ * list are wanted in order, or only the k-th smallest. The top-k algorithms
+ * leave the k smallest elements sorted at the front of the list and the
+ * rest after them in no particular order, as std::partial_sort does. The
+ * selection algorithms leave the k-th smallest element at index k - 1, with
+ * no larger element before it and no smaller one after it, as
+ * std::nth_element does. In both, k runs from 1 to n.
+ *
+ * The heap top-k keeps the k smallest elements seen so far in a max heap,
+ * sifted with Heap Sort's max_heapify(), and a partial Quick Sort only
+ * recurses into the sublists that overlap the first k positions. The
+ * introselect partitions with the naive Quick Sort's partition_sublist(),
+ * on a pivot chosen the way Quick Sort chooses one, and after too many
+ * levels hands what is left to the heap top-k. Floyd and Rivest's algorithm
+ * recursively selects its pivots from a sample chosen so that the k-th
+ * smallest element is very likely to fall between two of them, and takes
+ * little more than n comparisons on average.
+ */
+
+#ifndef SELECTION_H
+#define SELECTION_H
+
+/* include statements */
+#include <algorithm>
+#include <cmath>
+
+#include "sortalgos.h"
+
+/* constants */
+const int FLOYD_RIVEST_CUTOFF = 600;  /* Floyd-Rivest samples sublists longer than this */
+
+/* function declarations */
+template <typename T, typename Compare>
+void heap_top_k (T *v, int n, int k, Compare comp);
+template <typename T, typename Compare>
+void partial_quick_sort (T *v, int n, int k, Compare comp);
+template <typename T, typename Compare>
+void intro_select (T *v, int n, int k, Compare comp);
+template <typename T, typename Compare>
+void floyd_rivest_select (T *v, int n, int k, Compare comp);
+
+template <typename T, typename Compare>
+void partial_quick_sort_sublist (T *v, int start, int end, int last, int depth_limit,
+    Compare comp);
+template <typename T, typename Compare>
+void intro_select_sublist (T *v, int start, int end, int target, int depth_limit,
+    Compare comp);
+template <typename T, typename Compare>
+void floyd_rivest_sublist (T *v, int start, int end, int target, Compare comp);
+
+/*
+ * Move the k smallest of the n elements of the given list to its front, in
+ * sorted order, by building a max heap of the first k elements, replacing
+ * its root with every later element smaller than it, and finally sorting
+ * the heap in place.
+ */
+template <typename T, typename Compare>
+void heap_top_k (T *v, int n, int k, Compare comp)
+{
+    int i;  /* Index */
+
+    if (k < 1)
+        return;
+
+    for (i = k / 2 - 1; i >= 0; --i)
+        max_heapify(v, k, i, comp);
+
+    /* The root is the largest of the k smallest elements so far, so an
+     * element that is not below it can be passed over with one comparison. */
+    for (i = k; i < n; ++i) {
+        if (comp(v[i], v[0])) {
+            swap_elements(v[0], v[i]);
+            max_heapify(v, k, 0, comp);
+        }
+    }
+
+    for (i = k - 1; i > 0; --i) {
+        swap_elements(v[0], v[i]);
+        max_heapify(v, i, 0, comp);
+    }
+}
+
+/*
+ * Move the k smallest of the n elements of the given list to its front, in
+ * sorted order, using Martinez's partial Quick Sort: the introsort of
+ * quick_sort(), except that it never sorts a sublist lying wholly past the
+ * first k positions.
+ */
+template <typename T, typename Compare>
+void partial_quick_sort (T *v, int n, int k, Compare comp)
+{
+    if (k < 1)
+        return;
+
+    partial_quick_sort_sublist(v, 0, n - 1, k - 1, intro_depth_limit(n), comp);
+}
+
+/*
+ * Helper function for the partial Quick Sort that sorts the elements of
+ * v[start..end] that belong at indices up to last, allowing at most
+ * depth_limit further levels of partitioning before falling back to the
+ * heap top-k.
+ */
+template <typename T, typename Compare>
+void partial_quick_sort_sublist (T *v, int start, int end, int last, int depth_limit,
+    Compare comp)
+{
+    int left_end;     /* Last index of the sublist left of the pivot(s) */
+    int right_start;  /* First index of the sublist right of the pivot(s) */
+
+    while (end - start + 1 > INSERTION_SORT_CUTOFF && start <= last) {
+        if (depth_limit == 0) {
+            heap_top_k(v + start, end - start + 1, last - start + 1, comp);
+            return;
+        }
+
+        --depth_limit;
+        intro_partition(v, start, end, left_end, right_start, comp);
+
+        /* If every wanted position lies left of the pivot(s), the right
+         * sublist can stay unsorted. Otherwise the left sublist is wanted
+         * in full, and only what the right one holds is in doubt. */
+        if (last <= left_end) {
+            end = left_end;
+        } else {
+            intro_sort_sublist(v, start, left_end, depth_limit, comp);
+            start = right_start;
+        }
+    }
+
+    if (start <= last)
+        insertion_sort(v + start, end - start + 1, comp);
+}
+
+/*
+ * Move the k-th smallest of the n elements of the given list to index
+ * k - 1, with the smaller elements before it and the larger ones after it,
+ * using an introselect: a quickselect on the naive Quick Sort's partitioning
+ * that falls back to the heap top-k after 2 * log2(n) levels, guaranteeing
+ * O(n log n) time on every input. The partitioning puts all elements equal
+ * to the pivot on one side, so lists with many duplicates are the ones that
+ * reach the fallback.
+ */
+template <typename T, typename Compare>
+void intro_select (T *v, int n, int k, Compare comp)
+{
+    if (k < 1)
+        return;
+
+    intro_select_sublist(v, 0, n - 1, k - 1, intro_depth_limit(n), comp);
+}
+
+/*
+ * Helper function for the introselect that moves the element belonging at
+ * index target of v[start..end] there, allowing at most depth_limit further
+ * levels of partitioning before falling back to the heap top-k.
+ */
+template <typename T, typename Compare>
+void intro_select_sublist (T *v, int start, int end, int target, int depth_limit,
+    Compare comp)
+{
+    int middle;  /* Final index of the pivot after partitioning */
+
+    while (end - start + 1 > INSERTION_SORT_CUTOFF) {
+        if (depth_limit == 0) {
+            heap_top_k(v + start, end - start + 1, target - start + 1, comp);
+            return;
+        }
+
+        --depth_limit;
+
+        /* partition_sublist() pivots on the last element, so the chosen
+         * pivot is moved there from the first. */
+        choose_pivot(v, start, end, comp);
+        swap_elements(v[start], v[end]);
+        middle = partition_sublist(v, start, end, comp);
+
+        if (middle == target)
+            return;
+
+        if (target < middle)
+            end = middle - 1;
+        else
+            start = middle + 1;
+    }
+
+    insertion_sort(v + start, end - start + 1, comp);
+}
+
+/*
+ * Move the k-th smallest of the n elements of the given list to index
+ * k - 1, with the smaller elements before it and the larger ones after it,
+ * using Floyd and Rivest's SELECT algorithm.
+ */
+template <typename T, typename Compare>
+void floyd_rivest_select (T *v, int n, int k, Compare comp)
+{
+    if (k < 1)
+        return;
+
+    floyd_rivest_sublist(v, 0, n - 1, k - 1, comp);
+}
+
+/*
+ * Helper function for Floyd-Rivest selection that moves the element
+ * belonging at index target of v[start..end] there. Before partitioning a
+ * long sublist, the element of the sample around target that would fall
+ * at target is selected recursively, so that it can serve as the pivot,
+ * and the rest of the sample stays on either side of it. The sample is
+ * sized so that the pivot is very likely to land within a few elements of
+ * target.
+ */
+template <typename T, typename Compare>
+void floyd_rivest_sublist (T *v, int start, int end, int target, Compare comp)
+{
+    int i;        /* Index scanning forwards for elements >= pivot */
+    int j;        /* Index scanning backwards for elements <= pivot */
+    double size;  /* Length of the sublist */
+    double rank;  /* Rank of target within the sublist, from 1 */
+    double log_n; /* Natural logarithm of the length */
+    double s;     /* Length of the sample */
+    double sd;    /* Offset of the sample's bounds, biased towards the middle */
+
+    while (end > start) {
+        if (end - start > FLOYD_RIVEST_CUTOFF) {
+            size = end - start + 1;
+            rank = target - start + 1;
+            log_n = std::log(size);
+            s = 0.5 * std::exp(2 * log_n / 3);
+            sd = 0.5 * std::sqrt(log_n * s * (size - s) / size) *
+                (rank < size / 2 ? -1 : 1);
+
+            floyd_rivest_sublist(v,
+                std::max(start, (int) (target - rank * s / size + sd)),
+                std::min(end, (int) (target + (size - rank) * s / size + sd)),
+                target, comp);
+        }
+
+        /* Partition around v[target], with the pivot parked at v[start]
+         * and a sentinel no smaller than it at v[end], so that neither scan
+         * can run off the sublist. */
+        T pivot = v[target];
+
+        swap_elements(v[start], v[target]);
+        if (comp(pivot, v[end]))
+            swap_elements(v[start], v[end]);
+
+        i = start;
+        j = end;
+
+        while (i < j) {
+            swap_elements(v[i], v[j]);
+            ++i;
+            --j;
+
+            while (comp(v[i], pivot))
+                ++i;
+            while (comp(pivot, v[j]))
+                --j;
+        }
+
+        /* Move the pivot from whichever end it was parked at to its final
+         * index j. */
+        if (!comp(v[start], pivot) && !comp(pivot, v[start])) {
+            swap_elements(v[start], v[j]);
+        } else {
+            ++j;
+            swap_elements(v[j], v[end]);
+        }
+
+        if (j <= target)
+            start = j + 1;
+        if (target <= j)
+            end = j - 1;
+    }
+}
+
+#endif // SELECTION_H
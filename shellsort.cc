@@ -0,0 +1,70 @@
+/**
+ * A Shell Sort engine parameterized by its gap sequence. Each pass is an
+ * Insertion Sort of the elements a gap apart that shifts them instead of
+ * swapping them, holding the inserted element aside and writing it once it
+ * reaches its place. The sequences are Shell's original halving gaps,
+ * Knuth's (3^k - 1) / 2, Sedgewick's 4^k + 3 * 2^(k-1) + 1, Tokuda's
+ * ceil((9 (9/4)^k - 4) / 5), Ciura's experimentally found gaps, extended
+ * past 1750 by a factor of 2.25, and Pratt's 3-smooth numbers 2^p 3^q,
+ * which take many more passes but guarantee O(n log^2 n) time.
+ */
+
+#include "shellsort.h"
+
+/* The gaps found by Ciura to work best for up to about 4000 elements */
+static const int ciura_gaps[] = {1, 4, 10, 23, 57, 132, 301, 701, 1750};
+
+/*
+ * Fill gaps with the gaps of the given sequence that a Shell Sort of n
+ * elements uses, largest first and ending with 1 unless n is below 2.
+ */
+void shell_gaps (GapSequence sequence, int n, ScratchVector<int>& gaps)
+{
+    long long gap;  /* Next gap of an increasing sequence */
+
+    gaps.clear();
+
+    switch (sequence) {
+    case GAPS_SHELL:
+        for (gap = n / 2; gap > 0; gap /= 2)
+            gaps.push_back(gap);
+        return;
+    case GAPS_KNUTH:
+        /* Knuth suggests stopping below n / 3 */
+        for (gap = 1; gap == 1 || gap <= n / 3; gap = 3 * gap + 1)
+            gaps.push_back(gap);
+        break;
+    case GAPS_SEDGEWICK:
+        gaps.push_back(1);
+        for (int k = 1; (gap = (1LL << 2 * k) + 3 * (1LL << (k - 1)) + 1) < n; ++k)
+            gaps.push_back(gap);
+        break;
+    case GAPS_TOKUDA: {
+        double h = 1;  /* Unrounded term of the sequence */
+
+        for (gap = 1; gap < n; h = TOKUDA_RATIO * h + 1, gap = (long long) std::ceil(h))
+            gaps.push_back(gap);
+        break;
+    }
+    case GAPS_CIURA:
+        for (std::size_t i = 0; i < sizeof(ciura_gaps) / sizeof(ciura_gaps[0]); ++i)
+            gaps.push_back(ciura_gaps[i]);
+        gap = gaps.back();
+        while ((gap = (long long) (gap * CIURA_EXTENSION_RATIO)) < n)
+            gaps.push_back(gap);
+        break;
+    case GAPS_PRATT:
+        for (long long p = 1; p < n; p *= 2)
+            for (gap = p; gap < n; gap *= 3)
+                gaps.push_back(gap);
+        std::sort(gaps.begin(), gaps.end());
+        break;
+    }
+
+    /* The increasing sequences are listed smallest first, and only the
+     * gaps below n take part */
+    while (gaps.size() > 1 && gaps.back() >= n)
+        gaps.pop_back();
+
+    std::reverse(gaps.begin(), gaps.end());
+}
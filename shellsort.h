@@ -0,0 +1,71 @@
+/**
+ * A Shell Sort engine parameterized by its gap sequence. Each pass is an
+ * Insertion Sort of the elements a gap apart that shifts them instead of
+ * swapping them, holding the inserted element aside and writing it once it
+ * reaches its place. The sequences are Shell's original halving gaps,
+ * Knuth's (3^k - 1) / 2, Sedgewick's 4^k + 3 * 2^(k-1) + 1, Tokuda's
+ * ceil((9 (9/4)^k - 4) / 5), Ciura's experimentally found gaps, extended
+ * past 1750 by a factor of 2.25, and Pratt's 3-smooth numbers 2^p 3^q,
+ * which take many more passes but guarantee O(n log^2 n) time.
+ */
+
+#ifndef SHELLSORT_H
+#define SHELLSORT_H
+
+/* include statements */
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "scratcharena.h"
+
+/* The gap sequences a Shell Sort can use */
+enum GapSequence {
+    GAPS_SHELL,
+    GAPS_KNUTH,
+    GAPS_SEDGEWICK,
+    GAPS_TOKUDA,
+    GAPS_CIURA,
+    GAPS_PRATT
+};
+
+/* constants */
+const double TOKUDA_RATIO = 2.25;           /* Growth of the unrounded Tokuda gaps */
+const double CIURA_EXTENSION_RATIO = 2.25;  /* Ratio between Ciura gaps past the known ones */
+
+/* function declarations */
+template <typename T, typename Compare>
+void gapped_shell_sort (T *v, int n, GapSequence sequence, Compare comp);
+void shell_gaps (GapSequence sequence, int n, ScratchVector<int>& gaps);
+
+/*
+ * Sort the n elements of the given list in place using the Shell Sort
+ * algorithm with the given gap sequence.
+ */
+template <typename T, typename Compare>
+void gapped_shell_sort (T *v, int n, GapSequence sequence, Compare comp)
+{
+    ScratchVector<int> gaps;  /* Gaps of the passes, largest first */
+    int i, j;                 /* Indices */
+
+    shell_gaps(sequence, n, gaps);
+
+    for (std::size_t g = 0; g < gaps.size(); ++g) {
+        const int gap = gaps[g];
+
+        for (i = gap; i < n; ++i) {
+            if (!comp(v[i], v[i - gap]))
+                continue;
+
+            T x = std::move(v[i]);
+
+            for (j = i; j >= gap && comp(x, v[j - gap]); j -= gap)
+                v[j] = std::move(v[j - gap]);
+
+            v[j] = std::move(x);
+        }
+    }
+}
+
+#endif // SHELLSORT_H
@@ -0,0 +1,734 @@
+/**
+ * Vectorized sorting algorithms for ints. The SIMD Quick Sort partitions
+ * 16 or 8 elements at a time, comparing them against the pivot in one
+ * instruction and writing each side out with a compress-store (AVX-512) or
+ * a permutation from a lookup table (AVX2), in place, in the manner of
+ * Bramas' AVX-512 Quick Sort. The SIMD Merge Sort merges two sorted runs
+ * one register at a time with a bitonic merging network. Both finish short
+ * sublists with bitonic sorting networks held entirely in registers.
+ *
+ * The instruction set is chosen when the program starts, from what the CPU
+ * reports supporting, and can be lowered with --simd to compare them. The
+ * kernels are compiled for their instruction sets with target attributes,
+ * so the rest of the program needs no special flags, and machines without
+ * AVX2, or that are not x86, fall back to the scalar Quick and Merge Sorts.
+ */
+
+#include "simdsort.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMDSORT_X86 1
+/* In optimized builds, GCC 12 warns that the undefined source operands the
+ * AVX-512 intrinsics pass to their builtins are used uninitialized, which
+ * they never are (GCC bug 105593) */
+#ifndef __clang__
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+/* Names of the instruction sets, indexed by SimdIsa */
+static const char *simd_isa_names[] = {"scalar", "avx2", "avx512"};
+
+/*
+ * Return the instruction set the SIMD sorts currently use.
+ */
+static SimdIsa& active_isa ()
+{
+    static SimdIsa isa = detect_simd_isa();
+
+    return isa;
+}
+
+/*
+ * Merge the sorted lists a and b, of na and nb elements, into out.
+ */
+static void scalar_merge (const int *a, int na, const int *b, int nb, int *out)
+{
+    int i = 0, j = 0;  /* Indices into a and b */
+
+    while (i < na && j < nb)
+        *out++ = b[j] < a[i] ? b[j++] : a[i++];
+
+    out = std::copy(a + i, a + na, out);
+    std::copy(b + j, b + nb, out);
+}
+
+/*
+ * Merge the sorted lists a, b and c, of na, nb and nc elements, into out.
+ */
+static void scalar_merge3 (const int *a, int na, const int *b, int nb,
+    const int *c, int nc, int *out)
+{
+    int i = 0, j = 0, k = 0;  /* Indices into a, b and c */
+
+    while (i < na && j < nb && k < nc) {
+        if (a[i] <= b[j] && a[i] <= c[k])
+            *out++ = a[i++];
+        else if (b[j] <= c[k])
+            *out++ = b[j++];
+        else
+            *out++ = c[k++];
+    }
+
+    /* One list is exhausted, so merge the other two */
+    if (i == na)
+        scalar_merge(b + j, nb - j, c + k, nc - k, out);
+    else if (j == nb)
+        scalar_merge(a + i, na - i, c + k, nc - k, out);
+    else
+        scalar_merge(a + i, na - i, b + j, nb - j, out);
+}
+
+/*
+ * Sort the n elements of the given list in place using a Quick Sort whose
+ * partitions are computed by the given vectorized Partition, which moves
+ * the elements less than a pivot to the front and returns their number.
+ * Sublists of at most Cutoff elements are left to the given SortBlock, and
+ * after too many unbalanced partitions, to Heap Sort.
+ */
+template <int Cutoff, void (*SortBlock) (int *, int), int (*Partition) (int *, int, int)>
+static void vector_quick_sort (int *v, int n, int depth_limit)
+{
+    std::less<int> less;
+
+    while (n > Cutoff) {
+        if (depth_limit-- == 0) {
+            heap_sort(v, n, less);
+            return;
+        }
+
+        int pivot;
+        if (n > NINTHER_CUTOFF) {
+            const int step = n / 8;
+            int a = median_of_three(v, 0, step, 2 * step, less);
+            int b = median_of_three(v, n / 2 - step, n / 2, n / 2 + step, less);
+            int c = median_of_three(v, n - 1 - 2 * step, n - 1 - step, n - 1, less);
+            pivot = v[median_of_three(v, a, b, c, less)];
+        } else {
+            pivot = v[median_of_three(v, 0, n / 2, n - 1, less)];
+        }
+
+        int k = Partition(v, n, pivot);
+
+        /* If no element is below the pivot, the pivot is the smallest, so
+         * its copies are gathered at the front, where they belong. */
+        if (k == 0) {
+            if (pivot == INT_MAX)
+                return;
+
+            k = Partition(v, n, pivot + 1);
+            v += k;
+            n -= k;
+            continue;
+        }
+
+        /* Recurse into the smaller side and loop on the larger, to bound
+         * the depth of the stack */
+        if (k < n - k) {
+            vector_quick_sort<Cutoff, SortBlock, Partition>(v, k, depth_limit);
+            v += k;
+            n -= k;
+        } else {
+            vector_quick_sort<Cutoff, SortBlock, Partition>(v + k, n - k, depth_limit);
+            n = k;
+        }
+    }
+
+    SortBlock(v, n);
+}
+
+/*
+ * Sort the n elements of the given list in place using a bottom-up Merge
+ * Sort: blocks of Block elements are sorted by the given SortBlock and then
+ * merged in pairs by the given Merge, alternating between the list and an
+ * auxiliary buffer.
+ */
+template <int Block, void (*SortBlock) (int *, int),
+    void (*Merge) (const int *, int, const int *, int, int *)>
+static void vector_merge_sort (int *v, int n)
+{
+    int *src, *dst;  /* Input and output of a pass */
+
+    if (n <= Block) {
+        SortBlock(v, n);
+        return;
+    }
+
+    for (int i = 0; i < n; i += Block)
+        SortBlock(v + i, std::min(Block, n - i));
+
+    ScratchVector<int> buffer(n);
+    src = v;
+    dst = buffer.data();
+
+    for (int width = Block; width < n; width *= 2) {
+        for (int i = 0; i < n; i += 2 * width) {
+            int middle = std::min(i + width, n);
+            int end = std::min(i + 2 * width, n);
+
+            Merge(src + i, middle - i, src + middle, end - middle, dst + i);
+        }
+
+        std::swap(src, dst);
+    }
+
+    if (src != v)
+        std::copy(src, src + n, v);
+}
+
+#ifdef SIMDSORT_X86
+
+/*
+ * One step of a bitonic network on 8 ints: each lane is compared with the
+ * lane J away, and the lanes in MASK keep the larger of the two.
+ */
+template <int J, int MASK>
+TARGET_AVX2 static inline __m256i avx2_network_step (__m256i v)
+{
+    const __m256i partner = _mm256_setr_epi32(0 ^ J, 1 ^ J, 2 ^ J, 3 ^ J, 4 ^ J, 5 ^ J,
+        6 ^ J, 7 ^ J);
+    __m256i w = _mm256_permutevar8x32_epi32(v, partner);
+
+    return _mm256_blend_epi32(_mm256_min_epi32(v, w), _mm256_max_epi32(v, w), MASK);
+}
+
+/*
+ * Sort the 8 ints of the given register with a bitonic sorting network.
+ */
+TARGET_AVX2 static inline __m256i avx2_sort8 (__m256i v)
+{
+    v = avx2_network_step<1, 0x66>(v);
+    v = avx2_network_step<2, 0x3c>(v);
+    v = avx2_network_step<1, 0x5a>(v);
+    v = avx2_network_step<4, 0xf0>(v);
+    v = avx2_network_step<2, 0xcc>(v);
+    return avx2_network_step<1, 0xaa>(v);
+}
+
+/*
+ * Sort the 8 ints of the given bitonic register with a bitonic merging
+ * network.
+ */
+TARGET_AVX2 static inline __m256i avx2_bitonic_merge8 (__m256i v)
+{
+    v = avx2_network_step<4, 0xf0>(v);
+    v = avx2_network_step<2, 0xcc>(v);
+    return avx2_network_step<1, 0xaa>(v);
+}
+
+/*
+ * Merge the sorted registers a and b into the sorted pair lo and hi.
+ */
+TARGET_AVX2 static inline void avx2_merge16 (__m256i a, __m256i b, __m256i& lo, __m256i& hi)
+{
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256i r = _mm256_permutevar8x32_epi32(b, reverse);
+
+    lo = avx2_bitonic_merge8(_mm256_min_epi32(a, r));
+    hi = avx2_bitonic_merge8(_mm256_max_epi32(a, r));
+}
+
+/*
+ * Return the lanes of a register holding the first n of 8 elements.
+ */
+TARGET_AVX2 static inline __m256i avx2_lane_mask (int n)
+{
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(n),
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+/*
+ * Load the first n of 8 elements at the given address, filling the other
+ * lanes with INT_MAX, which sorts after every element.
+ */
+TARGET_AVX2 static inline __m256i avx2_load_padded (const int *p, int n)
+{
+    __m256i mask = avx2_lane_mask(n);
+
+    return _mm256_blendv_epi8(_mm256_set1_epi32(INT_MAX), _mm256_maskload_epi32(p, mask), mask);
+}
+
+/*
+ * Sort the n elements of the given list, at most 16, in registers.
+ */
+TARGET_AVX2 static void avx2_sort_block (int *v, int n)
+{
+    if (n < 2)
+        return;
+
+    __m256i a = avx2_sort8(avx2_load_padded(v, std::min(n, 8)));
+
+    if (n <= 8) {
+        _mm256_maskstore_epi32(v, avx2_lane_mask(n), a);
+        return;
+    }
+
+    __m256i b = avx2_sort8(avx2_load_padded(v + 8, n - 8));
+    __m256i lo, hi;
+
+    avx2_merge16(a, b, lo, hi);
+    _mm256_storeu_si256((__m256i *) v, lo);
+    _mm256_maskstore_epi32(v + 8, avx2_lane_mask(n - 8), hi);
+}
+
+/* For every 8-bit mask, the lanes set in it followed by the others */
+struct CompressTable {
+    int lanes[256][8];
+
+    CompressTable ()
+    {
+        for (int mask = 0; mask < 256; ++mask) {
+            int k = 0;
+
+            for (int i = 0; i < 8; ++i)
+                if (mask & (1 << i))
+                    lanes[mask][k++] = i;
+
+            for (int i = 0; i < 8; ++i)
+                if (!(mask & (1 << i)))
+                    lanes[mask][k++] = i;
+        }
+    }
+};
+
+/*
+ * Return the table of compressing permutations.
+ */
+static const CompressTable& compress_table ()
+{
+    static const CompressTable table;
+
+    return table;
+}
+
+/*
+ * Write the 8 elements of x out of a partition: those below the pivot at
+ * left, and the others ending at right, which then move past them. Both
+ * sides are written with full stores, so each must have 8 free slots.
+ */
+TARGET_AVX2 static inline void avx2_partition_store (int *v, __m256i x, __m256i pivot,
+    const CompressTable& table, int& left, int& right)
+{
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivot, x)));
+    int below = __builtin_popcount(mask);
+    __m256i packed = _mm256_permutevar8x32_epi32(x,
+        _mm256_loadu_si256((const __m256i *) table.lanes[mask]));
+
+    _mm256_storeu_si256((__m256i *) (v + left), packed);
+    _mm256_storeu_si256((__m256i *) (v + right - 8), packed);
+    left += below;
+    right -= 8 - below;
+}
+
+/*
+ * Write the first count of the 8 elements of x out of a partition as
+ * avx2_partition_store() does, but writing exactly count elements.
+ */
+TARGET_AVX2 static inline void avx2_partition_store_exact (int *v, __m256i x, int count,
+    __m256i pivot, const CompressTable& table, int& left, int& right)
+{
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pivot, x))) &
+        ((1 << count) - 1);
+    int below = __builtin_popcount(mask);
+    int packed[8];
+
+    _mm256_storeu_si256((__m256i *) packed, _mm256_permutevar8x32_epi32(x,
+        _mm256_loadu_si256((const __m256i *) table.lanes[mask])));
+
+    std::memcpy(v + left, packed, below * sizeof(int));
+    left += below;
+    right -= count - below;
+    std::memcpy(v + right, packed + below, (count - below) * sizeof(int));
+}
+
+/*
+ * Partition the n elements of the given list, at least 16, in place around
+ * the given pivot, returning the number of elements below it, which end up
+ * at the front. The first and last 8 elements are held in registers, which
+ * leaves 8 free slots at each end to write into, and each following block
+ * is read from the end with fewer free slots, so neither end runs out.
+ */
+TARGET_AVX2 static int avx2_partition (int *v, int n, int pivot)
+{
+    const CompressTable& table = compress_table();
+    const __m256i pivots = _mm256_set1_epi32(pivot);
+    int left = 0, right = n;           /* Next slots to write at each end */
+    int left_read = 8, right_read = n - 8;  /* Unread elements lie between these */
+
+    __m256i first = _mm256_loadu_si256((const __m256i *) v);
+    __m256i last = _mm256_loadu_si256((const __m256i *) (v + n - 8));
+
+    while (right_read - left_read >= 8) {
+        __m256i x;
+
+        if (left_read - left <= right - right_read) {
+            x = _mm256_loadu_si256((const __m256i *) (v + left_read));
+            left_read += 8;
+        } else {
+            right_read -= 8;
+            x = _mm256_loadu_si256((const __m256i *) (v + right_read));
+        }
+
+        avx2_partition_store(v, x, pivots, table, left, right);
+    }
+
+    /* Every unwritten element is now in a register, and only as many slots
+     * are free as there are elements to write. */
+    int rest = right_read - left_read;
+    __m256i x = avx2_load_padded(v + left_read, rest);
+
+    avx2_partition_store_exact(v, x, rest, pivots, table, left, right);
+    avx2_partition_store_exact(v, first, 8, pivots, table, left, right);
+    avx2_partition_store_exact(v, last, 8, pivots, table, left, right);
+
+    return left;
+}
+
+/*
+ * Merge the sorted lists a and b, of na and nb elements, into out, 8
+ * elements at a time. The register of the 8 largest elements merged so far
+ * is merged with the next 8 elements of whichever list has the smaller
+ * next element, and the smaller 8 of the result are final.
+ */
+TARGET_AVX2 static void avx2_merge (const int *a, int na, const int *b, int nb, int *out)
+{
+    int i = 8, j = 8;  /* Next unread elements of a and b */
+    __m256i lo, hi;    /* Smaller and larger halves of the last merge */
+    int rest[8];       /* The final larger half */
+
+    if (na < 8 || nb < 8) {
+        scalar_merge(a, na, b, nb, out);
+        return;
+    }
+
+    avx2_merge16(_mm256_loadu_si256((const __m256i *) a),
+        _mm256_loadu_si256((const __m256i *) b), lo, hi);
+    _mm256_storeu_si256((__m256i *) out, lo);
+    out += 8;
+
+    while (true) {
+        __m256i next;
+
+        if (j >= nb || (i < na && a[i] <= b[j])) {
+            if (na - i < 8)
+                break;
+            next = _mm256_loadu_si256((const __m256i *) (a + i));
+            i += 8;
+        } else {
+            if (nb - j < 8)
+                break;
+            next = _mm256_loadu_si256((const __m256i *) (b + j));
+            j += 8;
+        }
+
+        avx2_merge16(hi, next, lo, hi);
+        _mm256_storeu_si256((__m256i *) out, lo);
+        out += 8;
+    }
+
+    _mm256_storeu_si256((__m256i *) rest, hi);
+    scalar_merge3(rest, 8, a + i, na - i, b + j, nb - j, out);
+}
+
+/*
+ * One step of a bitonic network on 16 ints: each lane is compared with the
+ * lane j away, and the lanes in mask keep the larger of the two.
+ */
+TARGET_AVX512 static inline __m512i avx512_network_step (__m512i v, int j, __mmask16 mask)
+{
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+        14, 15);
+    __m512i w = _mm512_permutexvar_epi32(_mm512_xor_si512(lanes, _mm512_set1_epi32(j)), v);
+
+    return _mm512_mask_mov_epi32(_mm512_min_epi32(v, w), mask, _mm512_max_epi32(v, w));
+}
+
+/*
+ * Sort the 16 ints of the given register with a bitonic sorting network.
+ */
+TARGET_AVX512 static inline __m512i avx512_sort16 (__m512i v)
+{
+    v = avx512_network_step(v, 1, 0x6666);
+    v = avx512_network_step(v, 2, 0x3c3c);
+    v = avx512_network_step(v, 1, 0x5a5a);
+    v = avx512_network_step(v, 4, 0x0ff0);
+    v = avx512_network_step(v, 2, 0x33cc);
+    v = avx512_network_step(v, 1, 0x55aa);
+    v = avx512_network_step(v, 8, 0xff00);
+    v = avx512_network_step(v, 4, 0xf0f0);
+    v = avx512_network_step(v, 2, 0xcccc);
+    return avx512_network_step(v, 1, 0xaaaa);
+}
+
+/*
+ * Sort the 16 ints of the given bitonic register with a bitonic merging
+ * network.
+ */
+TARGET_AVX512 static inline __m512i avx512_bitonic_merge16 (__m512i v)
+{
+    v = avx512_network_step(v, 8, 0xff00);
+    v = avx512_network_step(v, 4, 0xf0f0);
+    v = avx512_network_step(v, 2, 0xcccc);
+    return avx512_network_step(v, 1, 0xaaaa);
+}
+
+/*
+ * Merge the sorted registers a and b into the sorted pair lo and hi.
+ */
+TARGET_AVX512 static inline void avx512_merge32 (__m512i a, __m512i b, __m512i& lo,
+    __m512i& hi)
+{
+    const __m512i reverse = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3,
+        2, 1, 0);
+    __m512i r = _mm512_permutexvar_epi32(reverse, b);
+
+    lo = avx512_bitonic_merge16(_mm512_min_epi32(a, r));
+    hi = avx512_bitonic_merge16(_mm512_max_epi32(a, r));
+}
+
+/*
+ * Return the mask of the first n of 16 lanes.
+ */
+static inline __mmask16 avx512_lane_mask (int n)
+{
+    return (__mmask16) ((1u << n) - 1);
+}
+
+/*
+ * Sort the n elements of the given list, at most 32, in registers, with
+ * the lanes past the end of the list filled with INT_MAX.
+ */
+TARGET_AVX512 static void avx512_sort_block (int *v, int n)
+{
+    const __m512i padding = _mm512_set1_epi32(INT_MAX);
+
+    if (n < 2)
+        return;
+
+    __mmask16 mask_a = avx512_lane_mask(std::min(n, 16));
+    __m512i a = avx512_sort16(_mm512_mask_loadu_epi32(padding, mask_a, v));
+
+    if (n <= 16) {
+        _mm512_mask_storeu_epi32(v, mask_a, a);
+        return;
+    }
+
+    __mmask16 mask_b = avx512_lane_mask(n - 16);
+    __m512i b = avx512_sort16(_mm512_mask_loadu_epi32(padding, mask_b, v + 16));
+    __m512i lo, hi;
+
+    avx512_merge32(a, b, lo, hi);
+    _mm512_storeu_si512(v, lo);
+    _mm512_mask_storeu_epi32(v + 16, mask_b, hi);
+}
+
+/*
+ * Write the elements of x in the given lanes out of a partition, count in
+ * all: those below the pivot compressed into the slots from left, and the
+ * others into the slots ending at right, which then move past them.
+ */
+TARGET_AVX512 static inline void avx512_partition_store (int *v, __m512i x, __mmask16 lanes,
+    int count, __m512i pivot, int& left, int& right)
+{
+    __mmask16 below = _mm512_mask_cmplt_epi32_mask(lanes, x, pivot);
+    int num_below = __builtin_popcount(below);
+
+    _mm512_mask_compressstoreu_epi32(v + left, below, x);
+    left += num_below;
+    right -= count - num_below;
+    _mm512_mask_compressstoreu_epi32(v + right, lanes & ~below, x);
+}
+
+/*
+ * Partition the n elements of the given list, at least 32, in place around
+ * the given pivot, returning the number of elements below it, which end up
+ * at the front. The first and last 16 elements are held in registers, which
+ * leaves 16 free slots at each end to write into, and each following block
+ * is read from the end with fewer free slots, so neither end runs out.
+ */
+TARGET_AVX512 static int avx512_partition (int *v, int n, int pivot)
+{
+    const __m512i pivots = _mm512_set1_epi32(pivot);
+    int left = 0, right = n;                  /* Next slots to write at each end */
+    int left_read = 16, right_read = n - 16;  /* Unread elements lie between these */
+
+    __m512i first = _mm512_loadu_si512(v);
+    __m512i last = _mm512_loadu_si512(v + n - 16);
+
+    while (right_read - left_read >= 16) {
+        __m512i x;
+
+        if (left_read - left <= right - right_read) {
+            x = _mm512_loadu_si512(v + left_read);
+            left_read += 16;
+        } else {
+            right_read -= 16;
+            x = _mm512_loadu_si512(v + right_read);
+        }
+
+        avx512_partition_store(v, x, 0xffff, 16, pivots, left, right);
+    }
+
+    int rest = right_read - left_read;
+    __mmask16 rest_lanes = avx512_lane_mask(rest);
+    __m512i x = _mm512_maskz_loadu_epi32(rest_lanes, v + left_read);
+
+    avx512_partition_store(v, x, rest_lanes, rest, pivots, left, right);
+    avx512_partition_store(v, first, 0xffff, 16, pivots, left, right);
+    avx512_partition_store(v, last, 0xffff, 16, pivots, left, right);
+
+    return left;
+}
+
+/*
+ * Merge the sorted lists a and b, of na and nb elements, into out, 16
+ * elements at a time, as avx2_merge() does 8 at a time.
+ */
+TARGET_AVX512 static void avx512_merge (const int *a, int na, const int *b, int nb, int *out)
+{
+    int i = 16, j = 16;  /* Next unread elements of a and b */
+    __m512i lo, hi;      /* Smaller and larger halves of the last merge */
+    int rest[16];        /* The final larger half */
+
+    if (na < 16 || nb < 16) {
+        scalar_merge(a, na, b, nb, out);
+        return;
+    }
+
+    avx512_merge32(_mm512_loadu_si512(a), _mm512_loadu_si512(b), lo, hi);
+    _mm512_storeu_si512(out, lo);
+    out += 16;
+
+    while (true) {
+        __m512i next;
+
+        if (j >= nb || (i < na && a[i] <= b[j])) {
+            if (na - i < 16)
+                break;
+            next = _mm512_loadu_si512(a + i);
+            i += 16;
+        } else {
+            if (nb - j < 16)
+                break;
+            next = _mm512_loadu_si512(b + j);
+            j += 16;
+        }
+
+        avx512_merge32(hi, next, lo, hi);
+        _mm512_storeu_si512(out, lo);
+        out += 16;
+    }
+
+    _mm512_storeu_si512(rest, hi);
+    scalar_merge3(rest, 16, a + i, na - i, b + j, nb - j, out);
+}
+
+#endif // SIMDSORT_X86
+
+/*
+ * Sort the n elements of the given list in place using a Quick Sort with
+ * vectorized partitioning and sorting networks for the smallest sublists,
+ * on the widest instruction set available.
+ */
+void simd_quick_sort (int *v, int n)
+{
+    switch (simd_isa()) {
+#ifdef SIMDSORT_X86
+    case SIMD_AVX512:
+        vector_quick_sort<32, avx512_sort_block, avx512_partition>(v, n,
+            intro_depth_limit(n));
+        break;
+    case SIMD_AVX2:
+        vector_quick_sort<16, avx2_sort_block, avx2_partition>(v, n, intro_depth_limit(n));
+        break;
+#endif
+    default:
+        quick_sort(v, n, std::less<int>());
+        break;
+    }
+}
+
+/*
+ * Sort the n elements of the given list in place using a Merge Sort with
+ * vectorized merging and sorting networks for the initial blocks, on the
+ * widest instruction set available.
+ */
+void simd_merge_sort (int *v, int n)
+{
+    switch (simd_isa()) {
+#ifdef SIMDSORT_X86
+    case SIMD_AVX512:
+        vector_merge_sort<32, avx512_sort_block, avx512_merge>(v, n);
+        break;
+    case SIMD_AVX2:
+        vector_merge_sort<16, avx2_sort_block, avx2_merge>(v, n);
+        break;
+#endif
+    default:
+        merge_sort(v, n, std::less<int>());
+        break;
+    }
+}
+
+/*
+ * Return the instruction set the SIMD sorts use.
+ */
+SimdIsa simd_isa ()
+{
+    return active_isa();
+}
+
+/*
+ * Return the widest instruction set the CPU supports.
+ */
+SimdIsa detect_simd_isa ()
+{
+#ifdef SIMDSORT_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+#endif
+
+    return SIMD_SCALAR;
+}
+
+/*
+ * Restrict the SIMD sorts to the given instruction set or a narrower one.
+ */
+void limit_simd_isa (SimdIsa isa)
+{
+    active_isa() = std::min(active_isa(), isa);
+}
+
+/*
+ * Parse the given instruction set name into isa, returning whether it
+ * names one of them.
+ */
+bool parse_simd_isa (const char *name, SimdIsa& isa)
+{
+    const int num_isas = sizeof(simd_isa_names) / sizeof(simd_isa_names[0]);
+
+    for (int i = 0; i < num_isas; ++i) {
+        if (!std::strcmp(name, simd_isa_names[i])) {
+            isa = (SimdIsa) i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Return the name of the given instruction set, as accepted by --simd.
+ */
+const char *simd_isa_name (SimdIsa isa)
+{
+    return simd_isa_names[isa];
+}
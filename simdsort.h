@@ -0,0 +1,46 @@
+/**
+ * Vectorized sorting algorithms for ints. The SIMD Quick Sort partitions
+ * 16 or 8 elements at a time, comparing them against the pivot in one
+ * instruction and writing each side out with a compress-store (AVX-512) or
+ * a permutation from a lookup table (AVX2), in place, in the manner of
+ * Bramas' AVX-512 Quick Sort. The SIMD Merge Sort merges two sorted runs
+ * one register at a time with a bitonic merging network. Both finish short
+ * sublists with bitonic sorting networks held entirely in registers.
+ *
+ * The instruction set is chosen when the program starts, from what the CPU
+ * reports supporting, and can be lowered with --simd to compare them. The
+ * kernels are compiled for their instruction sets with target attributes,
+ * so the rest of the program needs no special flags, and machines without
+ * AVX2, or that are not x86, fall back to the scalar Quick and Merge Sorts.
+ */
+
+#ifndef SIMDSORT_H
+#define SIMDSORT_H
+
+/* include statements */
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "sortalgos.h"
+
+/* The instruction sets the SIMD sorts can use, in increasing order */
+enum SimdIsa {
+    SIMD_SCALAR,
+    SIMD_AVX2,
+    SIMD_AVX512
+};
+
+/* function declarations */
+void simd_quick_sort (int *v, int n);
+void simd_merge_sort (int *v, int n);
+SimdIsa simd_isa ();
+SimdIsa detect_simd_isa ();
+void limit_simd_isa (SimdIsa isa);
+bool parse_simd_isa (const char *name, SimdIsa& isa);
+const char *simd_isa_name (SimdIsa isa);
+
+#endif // SIMDSORT_H
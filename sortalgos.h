@@ -0,0 +1,538 @@
+/**
+ * The serial comparison sorting algorithms. Each is a template over the
+ * element type T and a comparator comp, a strict weak ordering called as
+ * comp(a, b) to ask whether a belongs before b, so that every comparison is
+ * inlined into the instantiation for a particular type and comparator.
+ */
+
+#ifndef SORTALGOS_H
+#define SORTALGOS_H
+
+/* include statements */
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "scratcharena.h"
+
+/* constants */
+const int INSERTION_SORT_CUTOFF = 16;  /* Quick Sort uses Insertion Sort at or below this length */
+const int NINTHER_CUTOFF = 128;        /* Quick Sort pivots on a ninther above this length */
+
+/* function declarations */
+template <typename T, typename Compare> void insertion_sort (T *v, int n, Compare comp);
+template <typename T, typename Compare> void selection_sort (T *v, int n, Compare comp);
+template <typename T, typename Compare> void bubble_sort (T *v, int n, Compare comp);
+template <typename T, typename Compare> void heap_sort (T *v, int n, Compare comp);
+template <typename T, typename Compare> void merge_sort (T *v, int n, Compare comp);
+template <typename T, typename Compare> void quick_sort (T *v, int n, Compare comp);
+template <typename T, typename Compare> void naive_quick_sort (T *v, int n, Compare comp);
+template <typename T, typename Compare> void shell_sort (T *v, int n, Compare comp);
+
+template <typename T, typename Compare>
+void max_heapify (T *v, int n, int i, Compare comp);
+template <typename T, typename Compare>
+void merge_sort_sublist (T *src, T *dst, int start, int end, Compare comp);
+template <typename T, typename Compare>
+void merge_sublists (const T *src, T *dst, int start, int middle, int end, Compare comp);
+template <typename T, typename Compare>
+void quick_sort_sublist (T *v, int start, int end, Compare comp);
+template <typename T, typename Compare>
+int partition_sublist (T *v, int start, int end, Compare comp);
+template <typename T, typename Compare>
+void intro_sort_sublist (T *v, int start, int end, int depth_limit, Compare comp);
+template <typename T, typename Compare>
+void intro_partition (T *v, int start, int end, int& left_end, int& right_start,
+    Compare comp);
+template <typename T, typename Compare>
+void choose_pivot (T *v, int start, int end, Compare comp);
+template <typename T, typename Compare>
+int median_of_three (T *v, int a, int b, int c, Compare comp);
+template <typename T, typename Compare>
+int hoare_partition (T *v, int start, int end, Compare comp);
+template <typename T, typename Compare>
+void three_way_partition (T *v, int start, int end, int& lt, int& gt, Compare comp);
+inline int intro_depth_limit (int n);
+template <typename T> inline void swap_elements (T& a, T& b);
+
+/*
+ * Exchange the elements a and b, using the swap() of their type if it has
+ * one, so instrumented element types can count the swap.
+ */
+template <typename T>
+inline void swap_elements (T& a, T& b)
+{
+    using std::swap;
+    swap(a, b);
+}
+
+/*
+ * Sort the n elements of the given list in place using the Insertion Sort
+ * algorithm.
+ */
+template <typename T, typename Compare>
+void insertion_sort (T *v, int n, Compare comp)
+{
+    int i, j;  /* Indices */
+
+    for (i = 1; i < n; ++i) {
+        j = i;
+        while (j > 0 && comp(v[j], v[j - 1])) {
+            swap_elements(v[j], v[j - 1]);
+            --j;
+        }
+    }
+}
+
+/*
+ * Sort the n elements of the given list in place using the Selection Sort
+ * algorithm.
+ */
+template <typename T, typename Compare>
+void selection_sort (T *v, int n, Compare comp)
+{
+    int i, j;  /* Indices */
+    int min;   /* Index of minimum element in unsorted sublist */
+
+    for (i = 0; i < n - 1; ++i) {
+        min = i;
+        for (j = i + 1; j < n; ++j)
+            if (comp(v[j], v[min]))
+                min = j;
+
+        if (min != i)
+            swap_elements(v[i], v[min]);
+    }
+}
+
+/*
+ * Sort the n elements of the given list in place using the Bubble Sort
+ * algorithm.
+ */
+template <typename T, typename Compare>
+void bubble_sort (T *v, int n, Compare comp)
+{
+    int i;         /* Index */
+    bool swapped;  /* Indicates whether a swap has occurred on this pass */
+
+    swapped = true;
+
+    while (swapped) {
+        swapped = false;
+
+        for (i = 1; i < n; ++i) {
+            if (comp(v[i], v[i - 1])) {
+                swap_elements(v[i - 1], v[i]);
+                swapped = true;
+            }
+        }
+    }
+}
+
+/*
+ * Sort the n elements of the given list in place using the Heap Sort
+ * algorithm.
+ */
+template <typename T, typename Compare>
+void heap_sort (T *v, int n, Compare comp)
+{
+    int i;  /* Index */
+
+    for (i = n / 2 - 1; i >= 0; --i)
+        max_heapify(v, n, i, comp);
+
+    for (i = n - 1; i >= 0; --i) {
+        swap_elements(v[0], v[i]);
+        max_heapify(v, i, 0, comp);
+    }
+}
+
+/*
+ * Helper function for Heap Sort that constructs a max heap rooted at index i
+ * in the provided list of size n, assuming the binary trees rooted at i's
+ * left and right children are already max heaps.
+ */
+template <typename T, typename Compare>
+void max_heapify (T *v, int n, int i, Compare comp)
+{
+    int largest;  /* Index of largest list value among v[i] and its children */
+    int left;     /* Index of v[i]'s left child, if it exists */
+    int right;    /* Index of v[i]'s right child, if it exists */
+
+    largest = i;
+    left = 2 * i + 1;
+    right = 2 * i + 2;
+
+    if (left < n && comp(v[i], v[left]))
+        largest = left;
+    if (right < n && comp(v[largest], v[right]))
+        largest = right;
+
+    /* If v[i] is larger than its two children, then the max heap construction
+     * is done. Otherwise, we need to swap v[i] with the larger of its two
+     * children and repeat the process on the subtree rooted there. */
+    if (largest != i) {
+        swap_elements(v[i], v[largest]);
+        max_heapify(v, n, largest, comp);
+    }
+}
+
+/*
+ * Sort the n elements of the given list in place using the Merge Sort
+ * algorithm.
+ */
+template <typename T, typename Compare>
+void merge_sort (T *v, int n, Compare comp)
+{
+    if (n < 2)
+        return;
+
+    /* A single auxiliary buffer holding a copy of the list serves every
+     * level of the recursion. */
+    ScratchVector<T> buffer(v, v + n);
+
+    merge_sort_sublist(buffer.data(), v, 0, n - 1, comp);
+}
+
+/*
+ * Helper function for Merge Sort that sorts the sublist of dst with the
+ * specified start and end indices, using the Merge Sort algorithm. On entry
+ * src[start..end] must hold the same elements as dst[start..end]; src is
+ * used as the auxiliary buffer and is left in an unspecified order. The two
+ * lists swap roles at each level of the recursion, so every level moves each
+ * element exactly once.
+ */
+template <typename T, typename Compare>
+void merge_sort_sublist (T *src, T *dst, int start, int end, Compare comp)
+{
+    int middle;  /* Middle index of the sublist */
+
+    if (start < end) {
+        middle = start + ((end - start) / 2);
+        merge_sort_sublist(dst, src, start, middle, comp);
+        merge_sort_sublist(dst, src, middle + 1, end, comp);
+        merge_sublists(src, dst, start, middle, end, comp);
+    }
+}
+
+/*
+ * Helper function for Merge Sort that sorts dst[start..end] by merging the
+ * two sorted sublists src[start..middle] and src[middle + 1..end] into a
+ * single sorted list.
+ */
+template <typename T, typename Compare>
+void merge_sublists (const T *src, T *dst, int start, int middle, int end, Compare comp)
+{
+    int i;   /* Index into first initial sublist */
+    int j;   /* Index into second initial sublist */
+    int k;   /* Index into final merged sublist */
+
+    i = start;
+    j = middle + 1;
+    k = start;
+
+    /* Begin merging by repeatedly assigning the lesser of the two elements at
+     * the front of either sublist to the proper position in dst. */
+    while (i <= middle && j <= end) {
+        if (!comp(src[j], src[i]))
+            dst[k++] = src[i++];
+        else
+            dst[k++] = src[j++];
+    }
+
+    /* If elements remain in the left sublist that have not yet been added to
+     * dst, add them now. */
+    while (i <= middle)
+        dst[k++] = src[i++];
+
+    /* Otherwise, add the rest of the elements in the right sublist to dst. */
+    while (j <= end)
+        dst[k++] = src[j++];
+}
+
+/*
+ * Sort the n elements of the given list in place using the Quick Sort
+ * algorithm, in its introsort form. Pivots are chosen by median of three
+ * (or Tukey's ninther on large sublists), sublists are split with Hoare
+ * partitioning, or three-way partitioning when a run of duplicates is
+ * detected, and only the smaller side is recursed on. Small sublists are
+ * finished with Insertion Sort, and any sublist still unsorted after
+ * 2 * log2(n) levels of partitioning is handed to Heap Sort, guaranteeing
+ * O(n log n) time and O(log n) stack depth on every input.
+ */
+template <typename T, typename Compare>
+void quick_sort (T *v, int n, Compare comp)
+{
+    intro_sort_sublist(v, 0, n - 1, intro_depth_limit(n), comp);
+}
+
+/*
+ * Return the number of levels of partitioning allowed before an introsort
+ * of n elements falls back to Heap Sort, which is 2 * floor(log2(n)).
+ */
+inline int intro_depth_limit (int n)
+{
+    int depth_limit;  /* Levels of partitioning allowed before Heap Sort */
+
+    depth_limit = 0;
+    for (int m = n; m > 1; m /= 2)
+        depth_limit += 2;
+
+    return depth_limit;
+}
+
+/*
+ * Helper function for Quick Sort that sorts the sublist of the given list
+ * with the specified start and end indices, allowing at most depth_limit
+ * further levels of partitioning before falling back to Heap Sort.
+ */
+template <typename T, typename Compare>
+void intro_sort_sublist (T *v, int start, int end, int depth_limit, Compare comp)
+{
+    int left_end;     /* Last index of the sublist left of the pivot(s) */
+    int right_start;  /* First index of the sublist right of the pivot(s) */
+
+    while (end - start + 1 > INSERTION_SORT_CUTOFF) {
+        if (depth_limit == 0) {
+            heap_sort(v + start, end - start + 1, comp);
+            return;
+        }
+
+        --depth_limit;
+        intro_partition(v, start, end, left_end, right_start, comp);
+
+        if (left_end - start < end - right_start) {
+            intro_sort_sublist(v, start, left_end, depth_limit, comp);
+            start = right_start;
+        } else {
+            intro_sort_sublist(v, right_start, end, depth_limit, comp);
+            end = left_end;
+        }
+    }
+
+    if (start < end)
+        insertion_sort(v + start, end - start + 1, comp);
+}
+
+/*
+ * Helper function for Quick Sort that performs one level of partitioning on
+ * v[start..end]. On return, the elements of v[left_end + 1..right_start - 1]
+ * are in their final positions, and the sublists v[start..left_end] and
+ * v[right_start..end] remain to be sorted.
+ *
+ * Every element before v[start] is less than or equal to every element of
+ * the sublist, and v[start - 1] itself is a pivot already in its final
+ * position. So when the chosen pivot equals v[start - 1], the pivot is the
+ * sublist's minimum and probably one of many duplicates, which is when
+ * three-way partitioning pays off.
+ */
+template <typename T, typename Compare>
+void intro_partition (T *v, int start, int end, int& left_end, int& right_start,
+    Compare comp)
+{
+    int middle;  /* Final index of the pivot after Hoare partitioning */
+    int lt, gt;  /* Bounds of the elements equal to the pivot */
+
+    choose_pivot(v, start, end, comp);
+
+    if (start > 0 && !comp(v[start - 1], v[start])) {
+        three_way_partition(v, start, end, lt, gt, comp);
+        left_end = lt - 1;
+        right_start = gt + 1;
+    } else {
+        middle = hoare_partition(v, start, end, comp);
+        left_end = middle - 1;
+        right_start = middle + 1;
+    }
+}
+
+/*
+ * Helper function for Quick Sort that picks a pivot for v[start..end] and
+ * swaps it into v[start]. The pivot is the median of the first, middle and
+ * last elements, or for sublists longer than NINTHER_CUTOFF, the median of
+ * the medians of three such evenly spaced triples.
+ */
+template <typename T, typename Compare>
+void choose_pivot (T *v, int start, int end, Compare comp)
+{
+    int middle;  /* Middle index of the sublist */
+    int step;    /* Distance between the samples of a ninther */
+    int pivot;   /* Index of the chosen pivot */
+
+    middle = start + ((end - start) / 2);
+
+    if (end - start + 1 > NINTHER_CUTOFF) {
+        step = (end - start + 1) / 8;
+        pivot = median_of_three(v,
+            median_of_three(v, start, start + step, start + 2 * step, comp),
+            median_of_three(v, middle - step, middle, middle + step, comp),
+            median_of_three(v, end - 2 * step, end - step, end, comp), comp);
+    } else {
+        pivot = median_of_three(v, start, middle, end, comp);
+    }
+
+    swap_elements(v[start], v[pivot]);
+}
+
+/*
+ * Helper function for Quick Sort that returns whichever of the indices a, b
+ * and c holds the median of the three elements there.
+ */
+template <typename T, typename Compare>
+int median_of_three (T *v, int a, int b, int c, Compare comp)
+{
+    if (comp(v[a], v[b])) {
+        if (comp(v[b], v[c]))
+            return b;
+        return comp(v[a], v[c]) ? c : a;
+    }
+
+    if (comp(v[a], v[c]))
+        return a;
+    return comp(v[b], v[c]) ? c : b;
+}
+
+/*
+ * Helper function for Quick Sort that partitions v[start..end] around the
+ * pivot at v[start] using Hoare's scheme: two indices move towards each
+ * other from either end, swapping pairs of elements on the wrong sides. Both
+ * scans stop on elements equal to the pivot, which keeps the split balanced
+ * on duplicate-heavy input. The pivot is then moved to its final position,
+ * whose index is returned; every element before it is less than or equal to
+ * the pivot, and every element after it is greater than or equal to it.
+ */
+template <typename T, typename Compare>
+int hoare_partition (T *v, int start, int end, Compare comp)
+{
+    int i;      /* Index scanning forwards for elements >= pivot */
+    int j;      /* Index scanning backwards for elements <= pivot */
+    T pivot;    /* Value of the pivot element */
+
+    pivot = v[start];
+    i = start;
+    j = end + 1;
+
+    while (true) {
+        while (comp(v[++i], pivot))
+            if (i == end)
+                break;
+
+        /* v[start] holds the pivot, so this scan cannot run off the start */
+        while (comp(pivot, v[--j]))
+            ;
+
+        if (i >= j)
+            break;
+
+        swap_elements(v[i], v[j]);
+    }
+
+    swap_elements(v[start], v[j]);
+    return j;
+}
+
+/*
+ * Helper function for Quick Sort that partitions v[start..end] around the
+ * pivot at v[start] into three sublists using Dijkstra's Dutch national flag
+ * scheme: elements less than the pivot, then elements equal to it, then
+ * elements greater than it. On return the equal elements occupy v[lt..gt],
+ * already in their final positions.
+ */
+template <typename T, typename Compare>
+void three_way_partition (T *v, int start, int end, int& lt, int& gt, Compare comp)
+{
+    int i;      /* First index of sublist of elements yet to be examined */
+    T pivot;    /* Value of the pivot element */
+
+    pivot = v[start];
+    lt = start;
+    gt = end;
+    i = start + 1;
+
+    while (i <= gt) {
+        if (comp(v[i], pivot))
+            swap_elements(v[lt++], v[i++]);
+        else if (comp(pivot, v[i]))
+            swap_elements(v[i], v[gt--]);
+        else
+            ++i;
+    }
+}
+
+/*
+ * Sort the n elements of the given list in place using the textbook Quick
+ * Sort algorithm, which always pivots on the last element of each sublist.
+ * This degrades to quadratic time on sorted or reverse-sorted input, and is
+ * kept for comparison with the introsort above.
+ */
+template <typename T, typename Compare>
+void naive_quick_sort (T *v, int n, Compare comp)
+{
+    quick_sort_sublist(v, 0, n - 1, comp);
+}
+
+/*
+ * Helper function for the naive Quick Sort that sorts the sublist of the
+ * given list with the specified start and end indices. Only the shorter side
+ * of each partition is sorted recursively and the longer one in the loop, so
+ * the recursion stays logarithmically deep even when the partitions are as
+ * lopsided as they get on sorted input.
+ */
+template <typename T, typename Compare>
+void quick_sort_sublist (T *v, int start, int end, Compare comp)
+{
+    int middle;  /* Middle index of the sublist */
+
+    while (start < end) {
+        middle = partition_sublist(v, start, end, comp);
+        if (middle - start < end - middle) {
+            quick_sort_sublist(v, start, middle - 1, comp);
+            start = middle + 1;
+        } else {
+            quick_sort_sublist(v, middle + 1, end, comp);
+            end = middle - 1;
+        }
+    }
+}
+
+/*
+ * Helper function for the naive Quick Sort that partitions v[start..end] into
+ * two sublists, the first with all elements less than or equal to a chosen
+ * pivot element (in this case, the initial element at v[end]), and the rest
+ * with all elements greater than this pivot element. Return the index of the
+ * end of the end of the first sublist.
+ */
+template <typename T, typename Compare>
+int partition_sublist (T *v, int start, int end, Compare comp)
+{
+    int i;  /* Last index of sublist of elements found to be the pivot */
+    int j;  /* First index of sublist of elements yet to be examined */
+
+    i = start - 1;
+
+    for (j = start; j < end; ++j)
+        if (!comp(v[end], v[j]))
+            swap_elements(v[++i], v[j]);
+
+    swap_elements(v[++i], v[end]);
+    return i;
+}
+
+/*
+ * Sort the n elements of the given list in place using the Shell Sort
+ * algorithm, with Donald Shell's original proposed gap size sequence
+ * (n / 2, n / 4, n / 8, etc).
+ */
+template <typename T, typename Compare>
+void shell_sort (T *v, int n, Compare comp)
+{
+    int i, j;  /* Indices */
+    int gap;   /* Distance between elements being compared */
+
+    for (gap = n / 2; gap > 0; gap /= 2)
+        for (i = gap; i < n; ++i)
+            for (j = i; j >= gap && comp(v[j], v[j - gap]); j -= gap)
+                swap_elements(v[j], v[j - gap]);
+}
+
+#endif // SORTALGOS_H
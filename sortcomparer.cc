@@ -21,452 +21,1582 @@
  * average and total time performance for each algorithm. Supplying no
  * arguments will print both, with the individual results following the 
  * summary.
+ *
+ * Options following these arguments control how each algorithm is timed:
+ * "--warmup N" performs N untimed runs first, "--trials N" takes N timed
+ * trials, and "--budget-ms MS" keeps adding trials until MS milliseconds have
+ * been measured. With more than one trial, percentile statistics are printed
+ * beneath each time. "--threads N" sets the number of threads used by the
+ * parallel algorithms. "--max-quadratic-n N" skips the quadratic algorithms
+ * on datasets longer than N, and "--timeout-ms MS" skips cells predicted to
+ * take longer than MS milliseconds and abandons those that do, so that the
+ * remaining algorithms can still be compared on large datasets. "--type T"
+ * sorts the datasets as elements of type int (the default), int64, float,
+ * double, record, a 16-byte key with a payload, or wide, a key with a
+ * payload filling a 64-byte cache line. Records carry their original
+ * positions, so each algorithm is found stable or unstable from its output
+ * and ranked in the summary among the algorithms of its class, and wide
+ * records are also sorted indirectly, through pointers. "--counters" adds
+ * the hardware performance counters of each cell beneath its time, and
+ * "--membench" measures memory bandwidth, load latency and memcpy at each
+ * dataset's size first, and adds each cell's elements per second per core
+ * and the fraction of its streaming bound it reaches. A build made with
+ * "make counted" also prints the comparisons, swaps and writes of each.
+ * "--format csv" or "--format json" streams every trial of every cell, with
+ * the metadata of the run, to stdout in place of the text output, or to the
+ * file given by "--output FILE" alongside it. "--baseline FILE" compares
+ * every cell with the same cell of such an export, and exits with a nonzero
+ * status if any is significantly slower by more than "--threshold PCT"
+ * percent. "--sweep LO:HI" generates the dataset at every power of two
+ * length from 2^LO to 2^HI and adds a table of each algorithm's times as n
+ * grows, with a fitted power law and the cache each length fits in.
+ * "--jobs N" measures cells concurrently on N job workers pinned to their
+ * own CPUs ("--isolate" keeps them on separate physical cores, and
+ * "--numa-local" copies each dataset to its worker), and measures a sample
+ * of the cells again serially to flag any slowed by the concurrency.
+ * "--simd ISA" limits the vectorized int sorts to avx512, avx2 or scalar
+ * code, instead of the widest instruction set the CPU supports.
+ * "--external ALGO" instead sorts each dataset of a binary input file
+ * outside of memory, in sorted runs spilled to "--temp-dir DIR" and then
+ * merged, using at most "--memory-mb MB" megabytes, and prints the times
+ * of run generation and of merging. "--k K" measures the top-k and
+ * selection algorithms, beside std::partial_sort and std::nth_element, in
+ * place of the sorts, at each of a comma-separated list of ranks K, each a
+ * count or a percentage of the dataset's length. "--calibration FILE" adds
+ * Auto Sort, which probes each dataset's features and sorts it with the
+ * algorithm recorded in FILE as fastest on similar datasets, and records
+ * the fastest algorithm on each dataset of the run in FILE.
  */
 
 #include "sortcomparer.h"
 
 int main (int argc, char const *argv[])
 {
-    if (argc < 1 || argc > 2) {
-        std::cerr << "USAGE: ./sortcomparer [results OR summary]" << std::endl;
+    Options options;              /* Settings parsed from the command line */
+
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
         return -1;
     }
 
-    if (argc == 2) {
-        if (strcmp(argv[1], "results") && strcmp(argv[1], "summary")) {
-            std::cerr << "ERROR: Invalid program argument, try 'results' or 'summary'" 
-                << std::endl;
-            return -2;
+    DatasetStore store;           /* Storage behind the datasets input by the user */
+    PerfCounters counters;        /* Performance counters, if the user asked for them */
+    bool counters_open = false;   /* Whether any performance counter is open */
+    int status;                   /* Exit status of the benchmark */
+    std::vector<std::string> sweep_specs;  /* Specs of the datasets of a sweep */
+
+    /* Counters must be opened before the pool's threads are created, so that
+     * the threads inherit them. */
+    if (options.counters)
+        counters_open = open_perf_counters(counters);
+
+    init_thread_pool(options.threads);
+
+    if (options.simd > simd_isa())
+        std::cerr << "WARNING: This CPU does not support " << simd_isa_name(options.simd)
+            << ", using " << simd_isa_name(simd_isa()) << std::endl;
+
+    limit_simd_isa(options.simd);
+
+    /* A sweep generates its one dataset spec, uniform by default, at each
+     * length in turn. */
+    if (options.sweep) {
+        if (options.generate_specs.size() > 1) {
+            std::cerr << "ERROR: --sweep takes at most one --generate spec" << std::endl;
+            return -1;
         }
+
+        expand_sweep_specs(options.generate_specs.empty() ? "uniform" :
+            options.generate_specs[0], options.sweep_lo, options.sweep_hi, sweep_specs);
+
+        options.generate_specs.clear();
+        for (std::size_t i = 0; i < sweep_specs.size(); ++i)
+            options.generate_specs.push_back(sweep_specs[i].c_str());
+    }
+
+    if (options.external.algo)
+        return run_external_sort(options);
+
+    if (!options.generate_specs.empty()) {
+        if (!generate_datasets(store, options.generate_specs))
+            return -2;
+    } else if (!load_datasets(store, options.input_path)) {
+        return -2;
+    }
+
+    const std::vector<DatasetView>& datasets = store.views;
+    const int num_datasets = datasets.size();
+
+    /* If the user only wants the datasets converted to the binary format,
+     * there is nothing to time. */
+    if (options.convert_path) {
+        if (!write_binary_datasets(datasets, options.convert_path))
+            return -2;
+
+        std::cout << "Wrote " << num_datasets << " datasets to "
+            << options.convert_path << std::endl;
+        return 0;
+    }
+
+    /* Run the benchmark on the element type the user selected, with every
+     * algorithm instantiated for that type. */
+    switch (options.element_type) {
+    case ELEMENT_INT64:
+        status = run_benchmark<Benchmarked<std::int64_t> >(options, store,
+            counters_open ? &counters : NULL);
+        break;
+    case ELEMENT_FLOAT:
+        status = run_benchmark<Benchmarked<float> >(options, store,
+            counters_open ? &counters : NULL);
+        break;
+    case ELEMENT_DOUBLE:
+        status = run_benchmark<Benchmarked<double> >(options, store,
+            counters_open ? &counters : NULL);
+        break;
+    case ELEMENT_RECORD:
+        status = run_benchmark<Benchmarked<Record> >(options, store,
+            counters_open ? &counters : NULL);
+        break;
+    case ELEMENT_WIDE:
+        status = run_benchmark<Benchmarked<WideRecord> >(options, store,
+            counters_open ? &counters : NULL);
+        break;
+    case ELEMENT_INT:
+    default:
+        status = run_benchmark<Benchmarked<int> >(options, store,
+            counters_open ? &counters : NULL);
+        break;
     }
 
+    if (counters_open)
+        close_perf_counters(counters);
+
+    release_datasets(store);
+    return status;
+}
+
+/*
+ * Time every algorithm registered for elements of type T on every dataset
+ * in the given store, converted to that type, and print the summary and/or
+ * results the user requested, with the counts of the given performance
+ * counters if there are any. If the user asked for an export format, every
+ * trial is also streamed out as each cell completes, and if they gave a
+ * baseline, every cell is compared with it. Return the program's exit
+ * status, which is nonzero if any cell regressed or had too few trials to
+ * be compared.
+ */
+template <typename T>
+int run_benchmark (const Options& options, const DatasetStore& store,
+    const PerfCounters *counters)
+{
     TotalTimeMap total_times;     /* Map of algo names to total runtimes */
     ResultTimesMap result_times;  /* Map of algo names to lists of dataset runtimes */
-    SortAlgoMap sort_algos;       /* Map of algo names to implementation functions */
-    DatasetList datasets;         /* List of datasets input by the user */
-
-    sort_algos["Insertion Sort"] = insertion_sort;
-    sort_algos["Selection Sort"] = selection_sort;
-    sort_algos["Bubble Sort"] = bubble_sort;
-    sort_algos["Heap Sort"] = heap_sort;
-    sort_algos["Merge Sort"] = merge_sort;
-    sort_algos["Quick Sort"] = quick_sort;
-    sort_algos["Shell Sort"] = shell_sort;
+    SortAlgoMap<T> sort_algos;    /* Map of algo names to implementation functions */
+    HistoryMap histories;         /* Map of algo names to their largest timed datasets */
+    ResultExporter exporter;      /* Destination of the exported measurements */
+    RunMetadata metadata;         /* Facts about the run, exported with each record */
+    BaselineMap baseline;         /* Map of cells to their trials in the baseline */
+    std::vector<CellComparison> comparisons;  /* Cells compared with the baseline */
+    std::vector<InterferenceCheck> checks;    /* Concurrent cells measured again serially */
+    std::vector<CellFailure> failures;        /* Cells failing verification */
+    std::vector<DatasetView> datasets;        /* Datasets in the order they are measured */
+    std::vector<std::string> labels;          /* Description of each of them */
+    std::vector<int> ranks;                   /* Rank k to select on each, or 0 */
+    CalibrationTable calibration;             /* Fastest algorithms of earlier runs */
+    std::vector<DatasetCalibration> calibrations;  /* Fastest algorithm on each dataset */
+    BenchmarkOptions benchmark = options.benchmark;  /* Settings of the current dataset */
+    int status = 0;               /* Exit status of the benchmark */
+
+    /* Given ranks, the top-k and selection algorithms are measured instead
+     * of the sorts, on every dataset at every rank. */
+    if (options.ranks.empty())
+        register_sort_algos(sort_algos);
+    else
+        register_select_algos(sort_algos);
+
+    /* Auto Sort dispatches to the fastest algorithms of the calibration
+     * table, so it is only registered once the table has measurements for
+     * this element type. */
+    const char *type_name = element_type_name(options.element_type);
+    const bool calibrating = options.calibration_path && options.ranks.empty();
+
+    if (calibrating) {
+        if (!load_calibration(options.calibration_path, calibration))
+            return -2;
+
+        if (!install_auto_sort(sort_algos, calibration, type_name))
+            std::cerr << "WARNING: Calibration file " << options.calibration_path
+                << " has no usable " << type_name << " measurements yet, so " << AUTO_SORT_NAME
+                << " is left out of this run" << std::endl;
+    }
+
     const int num_algos = sort_algos.size();
 
-    read_in_datasets(datasets);
+    expand_select_datasets(store, options.ranks, datasets, labels, ranks);
     const int num_datasets = datasets.size();
 
-    /* Remember which of the summary and/or results the user has requested */
-    const bool summary_needed = (argc == 1) || (argc == 2 && !strcmp(argv[1], "summary"));
-    const bool results_needed = (argc == 1) || (argc == 2 && !strcmp(argv[1], "results"));
+    if (calibrating)
+        calibrations.resize(num_datasets, DatasetCalibration{FeatureClass(), "", 0, 0});
+
+    /* Allocate a single scratch buffer large enough for the largest dataset.
+     * Each algorithm sorts this buffer in place after it has been refilled
+     * from the pristine dataset, so no allocation or copying happens inside
+     * the timed region. Datasets are converted to the element type one at a
+     * time, into a buffer that is reused for each. The algorithms' own
+     * buffers come from a scratch arena, mapped and faulted in just before
+     * the measurements. Concurrent job workers have buffers and arenas of
+     * their own instead. */
+    std::vector<T> scratch;
+    std::vector<T> elements;
+    int max_dataset_size = 0;
+
+    for (int i = 0; i < num_datasets; ++i)
+        max_dataset_size = std::max(max_dataset_size, datasets[i].size);
+
+    if (options.concurrent.jobs <= 1)
+        scratch.resize(max_dataset_size);
+
+    /* Exported records going to stdout replace the text output, so that the
+     * stream can be parsed. */
+    const bool export_needed = options.format != FORMAT_TEXT;
+    const bool text_needed = !export_needed || options.output_path;
+    const bool summary_needed = options.summary_needed && text_needed;
+    const bool results_needed = options.results_needed && text_needed;
+
+    if (options.baseline_path && !load_baseline(options.baseline_path, baseline))
+        return -2;
+
+    if (export_needed) {
+        collect_run_metadata(metadata, thread_pool().num_threads(),
+            element_type_name(options.element_type));
+
+        if (!open_exporter(exporter, options.format, options.output_path, metadata))
+            return -2;
+    }
+
+    /* The memory is measured before any cell, along with memcpy at the size
+     * of every dataset, which gives each cell its streaming bound. */
+    MemoryProfile memory;
+    std::vector<double> copy_gbps;
+
+    if (options.membench) {
+        std::unordered_map<long long, double> size_gbps;
+        CacheSizes caches;
+
+        if (text_needed)
+            std::cout << "Measuring memory bandwidth and latency..." << std::endl;
+
+        detect_cache_sizes(caches);
+        measure_memory_profile(caches, memory);
+
+        for (int i = 0; i < num_datasets; ++i) {
+            const long long bytes = (long long) datasets[i].size * sizeof(T);
+
+            if (size_gbps.find(bytes) == size_gbps.end())
+                size_gbps[bytes] = measure_copy_bandwidth(bytes);
+            copy_gbps.push_back(size_gbps[bytes]);
+        }
+    }
+
+    auto streaming_ns = [&] (int i) {
+        return copy_gbps[i] > 0 ? datasets[i].size * sizeof(T) / copy_gbps[i] : 0.0;
+    };
 
     /* If the user has requested individual dataset results, initialize the
-     * list of runtimes for each algorithm with enough capacity for all 
-     * datasets. */
-    if (results_needed)
+     * list of runtimes for each algorithm with a cell for every dataset. */
+    if (results_needed || options.sweep)
         for (auto iter = sort_algos.begin(); iter != sort_algos.end(); ++iter)
-            result_times[iter->first].reserve(num_datasets);
-
-    /* Time the execution of each sorting algorithm on each dataset, and store
-     * the resulting runtimes individually in that algorithm's list (if the 
-     * user has requested individual results) and/or as a part of that algorithm's
-     * sum total running time (if the user has requested a summary). */
-    for (int i = 0; i < num_datasets; ++i) {
-        std::cout << "Running sort algorithms on dataset " << (i + 1) << "..." << std::endl;
-
-        for (auto iter = sort_algos.begin(); iter != sort_algos.end(); ++iter) {
-            std::string algo = iter->first;
-            long long duration;
-                
-            Clock::time_point start_time = Clock::now();
-            iter->second(datasets[i]);
-            Clock::time_point end_time = Clock::now(); 
-
-            duration = std::chrono::duration_cast<std::chrono::microseconds>
-                (end_time - start_time).count();
-
-            if (summary_needed) {
-                if (total_times.find(algo) == total_times.end())
-                    total_times[algo] = duration;
-                else
-                    total_times[algo] += duration;
+            result_times[iter->first].resize(num_datasets);
+
+    /* Store the runtime statistics of each measured cell individually in its
+     * algorithm's list (if the user has requested individual results) and/or
+     * as a part of that algorithm's sum total running time (if the user has
+     * requested a summary), and export it and compare it with the baseline
+     * if the user asked for that. Cells that are skipped, aborted or failed
+     * count towards neither total, and are reported as such. */
+    auto record_cell = [&] (int i, const std::string& algo, const CellResult& cell,
+            const std::vector<long long>& samples) {
+        const bool failed = cell.status == CELL_UNSORTED || cell.status == CELL_CORRUPTED;
+
+        if (failed)
+            failures.push_back(CellFailure{algo, i + 1, cell.status});
+
+        if (export_needed)
+            export_cell(exporter, algo, i + 1, i < (int) labels.size() ?
+                labels[i] : "", datasets[i].size, cell, samples);
+
+        /* Compare the cell with the baseline when it was measured there on a
+         * dataset of the same size */
+        if (options.baseline_path && !samples.empty()) {
+            auto found = baseline.find(baseline_key(algo, i + 1));
+
+            if (found != baseline.end() && found->second.size == datasets[i].size) {
+                comparisons.push_back(CellComparison{algo, i + 1, BaselineComparison()});
+                compare_with_baseline(found->second.samples, samples,
+                    options.threshold_pct / 100.0, comparisons.back().comparison);
+            }
+        }
+
+        if (summary_needed) {
+            if (total_times.find(algo) == total_times.end())
+                total_times[algo] = AlgoTotals{TrialStats(), cell.counters,
+                    OpCounts{0, 0, 0}, 0, 0, 0, 0, 0, 0, STABILITY_UNTESTED};
+
+            AlgoTotals& totals = total_times[algo];
+
+            if (!failed)
+                totals.stability = combine_stability(totals.stability, cell.stability);
+
+            if (failed) {
+                ++totals.failed;
+            } else if (cell.status != CELL_MEASURED) {
+                ++totals.skipped;
+            } else {
+                if (totals.measured++ == 0) {
+                    totals.stats = cell.stats;
+                    totals.counters = cell.counters;
+                } else {
+                    accumulate_trial_stats(totals.stats, cell.stats);
+                    accumulate_counter_values(totals.counters, cell.counters);
+                }
+
+                totals.ops.comparisons += cell.ops.comparisons;
+                totals.ops.swaps += cell.ops.swaps;
+                totals.ops.writes += cell.ops.writes;
+                totals.bound += complexity_growth(COMPLEXITY_N_LOG_N, datasets[i].size);
+                totals.elements += datasets[i].size;
+                if (options.membench)
+                    totals.streaming_ns += streaming_ns(i);
+            }
+        }
+
+        if (results_needed || options.sweep)
+            result_times[algo][i] = cell;
+
+        /* Keep the fastest algorithm on each dataset for the calibration
+         * table, which Auto Sort itself is kept out of */
+        if (calibrating && cell.status == CELL_MEASURED) {
+            DatasetCalibration& best = calibrations[i];
+
+            if (algo == AUTO_SORT_NAME) {
+                best.auto_ns = cell.stats.median;
+            } else if (best.fastest.empty() || cell.stats.median < best.fastest_ns) {
+                best.fastest = algo;
+                best.fastest_ns = cell.stats.median;
             }
+        }
+    };
+
+#ifdef SORTCOMPARER_COUNT_OPS
+    if (text_needed)
+        std::cout << "Counting comparisons, swaps and writes; times include the "
+            "cost of counting" << std::endl;
+#endif
+
+    /* With several jobs, the cells are spread over pinned job workers, and a
+     * sample of them is measured again serially to check for interference.
+     * Otherwise the cells are measured one after another, a dataset at a
+     * time. */
+    if (options.concurrent.jobs > 1) {
+        std::vector<CpuInfo> cpus;
+
+        assign_job_cpus(options.concurrent, cpus);
+
+        if (text_needed) {
+            std::cout << "Running sort algorithms on " << num_datasets << " datasets with "
+                << cpus.size() << " job workers on CPUs";
+            for (std::size_t w = 0; w < cpus.size(); ++w)
+                std::cout << (w ? ", " : " ") << cpus[w].cpu;
+            std::cout << "..." << std::endl;
+        }
+
+        run_concurrent_cells(sort_algos, datasets, options.benchmark, cpus,
+            options.concurrent.numa_local, record_cell, checks);
+    } else {
+        std::vector<long long> samples;
+        ScratchArena arena;
 
-            if (results_needed)
-                result_times[algo].push_back(duration);
+        if (create_scratch_arena(arena, scratch_arena_bytes(max_dataset_size * sizeof(T)))) {
+            use_scratch_arena(&arena);
+
+            if (text_needed)
+                std::cout << "Taking scratch memory from a " << (arena.capacity >> 20)
+                    << " megabyte arena on " << arena_pages_name(arena.pages) << std::endl;
         }
+
+        for (int i = 0; i < num_datasets; ++i) {
+            if (text_needed) {
+                std::cout << "Running sort algorithms on dataset " << (i + 1);
+                if (i < (int) labels.size())
+                    std::cout << " (" << labels[i] << ")";
+                std::cout << "..." << std::endl;
+            }
+
+            const T *data = convert_dataset(datasets[i], elements);
+            Fingerprint reference;
+
+            fingerprint_elements(data, datasets[i].size, reference);
+            benchmark.k = ranks[i];
+
+            for (auto iter = sort_algos.begin(); iter != sort_algos.end(); ++iter) {
+                CellResult cell;
+
+                measure_cell(iter->second, data, datasets[i].size, reference, scratch,
+                    benchmark, counters, histories[iter->first], samples, cell);
+                record_cell(i, iter->first, cell, samples);
+            }
+        }
+
+        if (arena.overflows > 0)
+            std::cerr << "WARNING: " << arena.overflows << " scratch allocations did not "
+                "fit in the arena and were made on the heap" << std::endl;
+
+        use_scratch_arena(NULL);
+        destroy_scratch_arena(arena);
     }
 
-    std::cout << std::endl;
+    if (export_needed)
+        close_exporter(exporter);
+
+    if (text_needed)
+        std::cout << std::endl;
+
+    if (options.membench && text_needed) {
+        std::cout << "==================== MEMORY ====================" << std::endl;
+        std::cout << std::setprecision(3) << std::fixed;
+        print_memory_profile(memory, datasets, copy_gbps, sizeof(T));
+    }
 
-    /* Sort the list of sorting algorithms in increasing order of their total
-     * execution time over all datasets, and print the algorithm names in order
-     * with their total and average runtimes. */
+    /* Sort the list of sorting algorithms in decreasing order of the number
+     * of datasets they were measured on, and then in increasing order of their
+     * total median execution time over those datasets, and print the algorithm
+     * names in order with their total and average runtimes. */
     if (summary_needed) {
-        std::vector<TimePair> fast_to_slow;
+        std::vector<TotalPair> fast_to_slow;
         fast_to_slow.reserve(num_algos);
         
         for (auto iter = total_times.begin(); iter != total_times.end(); ++iter)
             fast_to_slow.emplace_back(iter->first, iter->second);
         
-        std::sort(fast_to_slow.begin(), fast_to_slow.end(), compare_times);
+        std::sort(fast_to_slow.begin(), fast_to_slow.end(), compare_totals);
+
+        /* Elements that carry their original positions show which algorithms
+         * are stable, and each class is ranked on its own. */
+        const bool by_stability = PositionTraits<T>::tracked;
+        int rank = 0;
+
+        if (by_stability)
+            std::stable_sort(fast_to_slow.begin(), fast_to_slow.end(), compare_stability);
 
         std::cout << "==================== SUMMARY ====================" << std::endl;
         std::cout << std::setprecision(3) << std::fixed;
 
         for (int i = 0; i < num_algos; ++i) {
             std::string algo = fast_to_slow[i].first;
-            long long total_time = fast_to_slow[i].second;
-            double avg_time = (double) total_time / num_datasets;
+            const AlgoTotals& totals = fast_to_slow[i].second;
+            double total_time = totals.stats.median / 1000;
+            double avg_time = total_time / std::max(totals.measured, 1);
+
+            if (by_stability && (i == 0 ||
+                    totals.stability != fast_to_slow[i - 1].second.stability)) {
+                std::cout << stability_heading(totals.stability) << std::endl;
+                rank = 0;
+            }
+
+            ++rank;
 
-            std::cout << (i + 1) << ". " << algo << ": total time " << total_time << 
+            if (totals.measured == 0) {
+                std::cout << rank << ". " << algo << ": not measured on any of the "
+                    << num_datasets << " datasets";
+                if (totals.failed)
+                    std::cout << " (FAILED on " << totals.failed << ")";
+                std::cout << std::endl;
+                continue;
+            }
+
+            std::cout << rank << ". " << algo << ": total time " << total_time << 
                 " microseconds, or " << avg_time << 
-                " microseconds per dataset on average" << std::endl;
+                " microseconds per dataset on average";
+
+            if (totals.skipped)
+                std::cout << " (" << totals.skipped << " of " << num_datasets
+                    << " datasets skipped or aborted)";
+
+            if (totals.failed)
+                std::cout << " (FAILED on " << totals.failed << " of " << num_datasets
+                    << " datasets)";
+
+            std::cout << std::endl;
+
+            if (options.benchmark.trials > 1 || options.benchmark.budget_ns > 0)
+                print_trial_stats(totals.stats);
+
+            if (counters)
+                print_counter_values(totals.counters);
+
+            if (options.membench)
+                print_throughput(totals.elements, totals.stats.median,
+                    sort_algos.at(algo).uses_pool ? thread_pool().num_threads() : 1,
+                    totals.streaming_ns);
+
+#ifdef SORTCOMPARER_COUNT_OPS
+            print_op_counts(totals.ops, totals.bound);
+#endif
         }
 
         std::cout << std::endl;
     }
 
+    /* Print each algorithm's times over the lengths of the sweep, with the
+     * algorithms in alphabetical order. */
+    if (options.sweep && text_needed) {
+        std::vector<std::string> names;
+        CacheSizes caches;
+
+        for (auto iter = sort_algos.begin(); iter != sort_algos.end(); ++iter)
+            names.push_back(iter->first);
+        std::sort(names.begin(), names.end());
+
+        detect_cache_sizes(caches);
+
+        std::cout << "==================== SWEEP ====================" << std::endl;
+        std::cout << "Caches: L1d " << caches.l1d / 1024 << " KiB, L2 " << caches.l2 / 1024
+            << " KiB, LLC " << caches.llc / 1024 << " KiB; working set " << sizeof(T)
+            << " bytes per element" << std::endl << std::endl;
+
+        for (std::size_t i = 0; i < names.size(); ++i)
+            print_sweep_table(names[i], result_times[names[i]], datasets, sizeof(T),
+                caches);
+    }
+
     if (results_needed) {
         std::vector<TimePair> fast_to_slow;
         fast_to_slow.reserve(num_algos);
 
         std::cout << "==================== RESULTS ====================" << std::endl;
+        std::cout << std::setprecision(3) << std::fixed;
 
         /* For each dataset, sort the list of sorting algorithms in increasing order
-         * of execution time on that dataset, and print the algorithm names in order
-         * with their runtimes. */
+         * of median execution time on that dataset, and print the algorithm names
+         * in order with their runtimes. Algorithms that were skipped, aborted
+         * or failed on the dataset are listed last. */
         for (int i = 0; i < num_datasets; ++i) {
             fast_to_slow.clear();            
 
-            for (auto iter = result_times.begin(); iter != result_times.end(); ++iter)
-                fast_to_slow.emplace_back(iter->first, iter->second[i]);
+            for (auto iter = result_times.begin(); iter != result_times.end(); ++iter) {
+                const CellResult& cell = iter->second[i];
+
+                fast_to_slow.emplace_back(iter->first, cell.status == CELL_MEASURED ?
+                    cell.stats.median : std::numeric_limits<double>::infinity());
+            }
 
             std::sort(fast_to_slow.begin(), fast_to_slow.end(), compare_times);
 
-            std::cout << "DATASET " << (i + 1) << ":" << std::endl;
+            std::cout << "DATASET " << (i + 1);
+            if (ranks[i] > 0)
+                std::cout << " (k = " << ranks[i] << " of " << datasets[i].size << ")";
+            std::cout << ":" << std::endl;
 
             for (int j = 0; j < num_algos; ++j) {
                 std::string algo = fast_to_slow[j].first;
-                long long result_time = fast_to_slow[j].second;
+                const CellResult& cell = result_times[algo][i];
+
+                if (cell.status != CELL_MEASURED) {
+                    std::cout << (j + 1) << ". " << algo << ": ";
+                    print_cell_status(cell);
+                    continue;
+                }
+
+                double result_time = fast_to_slow[j].second / 1000;
                 std::cout << (j + 1) << ". " << algo << ": " << result_time 
-                    << " microseconds" << std::endl;
+                    << " microseconds";
+                if (cell.stability == STABILITY_BROKEN)
+                    std::cout << ", unstable";
+                std::cout << std::endl;
+
+                if (options.benchmark.trials > 1 || options.benchmark.budget_ns > 0)
+                    print_trial_stats(cell.stats);
+
+                if (counters)
+                    print_counter_values(cell.counters);
+
+                if (options.membench)
+                    print_throughput(datasets[i].size, cell.stats.median,
+                        sort_algos.at(algo).uses_pool ? thread_pool().num_threads() : 1,
+                        streaming_ns(i));
+
+#ifdef SORTCOMPARER_COUNT_OPS
+                print_op_counts(cell.ops, complexity_growth(COMPLEXITY_N_LOG_N,
+                    datasets[i].size));
+#endif
             }
 
             std::cout << std::endl;
         }
     }
 
-    return 0;
+    /* Record the fastest algorithm on each dataset under the dataset's
+     * feature class, measured by the same probe Auto Sort runs, and save the
+     * table for the next run. */
+    if (calibrating) {
+        for (int i = 0; i < num_datasets; ++i) {
+            DatasetFeatures features;
+
+            probe_features(convert_dataset(datasets[i], elements), datasets[i].size,
+                features);
+            classify_features(features, calibrations[i].features);
+
+            if (!calibrations[i].fastest.empty())
+                update_calibration(calibration, CalibrationEntry{type_name,
+                    calibrations[i].features, calibrations[i].fastest_ns,
+                    calibrations[i].fastest});
+        }
+
+        if (text_needed) {
+            std::cout << "==================== CALIBRATION ====================" << std::endl;
+            std::cout << std::setprecision(3) << std::fixed;
+            print_calibration(calibrations);
+        }
+
+        if (!save_calibration(options.calibration_path, calibration))
+            status = -2;
+    }
+
+    if (options.concurrent.jobs > 1 && text_needed) {
+        std::cout << "==================== INTERFERENCE ====================" << std::endl;
+        std::cout << std::setprecision(3) << std::fixed;
+        print_interference_checks(checks);
+    }
+
+    if (options.baseline_path) {
+        if (text_needed) {
+            std::cout << "==================== BASELINE ====================" << std::endl;
+            std::cout << std::setprecision(3) << std::fixed;
+        }
+
+        int regressed = print_baseline_comparisons(comparisons, text_needed);
+        int untested = 0;  /* Cells with too few trials on either side */
+
+        for (std::size_t i = 0; i < comparisons.size(); ++i)
+            if (!comparisons[i].comparison.tested)
+                ++untested;
+
+        if (comparisons.empty())
+            std::cerr << "WARNING: No cell of this run appears in the baseline "
+                << options.baseline_path << std::endl;
+
+        if (regressed) {
+            std::cerr << "ERROR: " << regressed << " of " << comparisons.size()
+                << " cells are significantly slower than the baseline by more than "
+                << options.threshold_pct << "%" << std::endl;
+            status = -3;
+        }
+
+        /* A cell that was not tested could have regressed unnoticed */
+        if (untested) {
+            std::cerr << "ERROR: " << untested << " of " << comparisons.size()
+                << " cells have too few trials in this run or the baseline to be tested, "
+                << "use --trials " << BASELINE_MIN_TRIALS << " or more in both" << std::endl;
+            status = -3;
+        }
+    }
+
+    /* Every cell whose output was wrong is named, whatever the output format */
+    for (std::size_t i = 0; i < failures.size(); ++i) {
+        std::cerr << "ERROR: " << failures[i].algo << " failed on dataset "
+            << failures[i].dataset << ": its output "
+            << (failures[i].status == CELL_CORRUPTED ? "is not a permutation of the dataset" :
+                options.ranks.empty() ? "is not sorted" :
+                "is not in the order promised at rank k") << std::endl;
+        status = -3;
+    }
+
+    return status;
 }
 
 /*
- * Read the lists of integers entered by the user via stdin into the specified 
- * list of datasets. If the user enters a token that could not be parsed as an
- * integer, the program will notify the user of the failure but still attempt
- * to parse the rest of the dataset.
+ * Sort every dataset of the binary input file outside of memory, with the
+ * registered int algorithm the user named sorting the runs, and print what
+ * each sort did and how long its phases took. Return the program's exit
+ * status, which is nonzero if any output was not sorted or any input did
+ * not match its checksum.
  */
-void read_in_datasets (DatasetList& datasets) 
+int run_external_sort (const Options& options)
 {
-    bool errors_occured;       /* Whether any parse errors have occurred */
-    int elem;                  /* Current element being parsed */
-    int linecount;             /* Line counter, for error reporting */
-    int position;              /* Position counter, for error reporting */
-    std::string data_str;      /* Dataset entered on the current line */
-    std::vector<int> dataset;  /* List of elements in current dataset */
-
-    std::getline(std::cin, data_str);
-    linecount = 1;
-    errors_occured = false;
-
-    while (!std::cin.eof() && !data_str.empty()) {
-        dataset.clear();
-
-        std::stringstream ss(data_str);
-        position = 1;
-
-        while (ss >> elem || !ss.eof()) {
-            if (ss.fail()) {
-                errors_occured = true;
-                std::cerr << "ERROR: Failed to convert element at line " 
-                    << linecount << ", position " << position 
-                    << " to an integer" << std::endl;
-
-                ss.clear();
-                std::string temp;
-                ss >> temp;
-            } else {
-                dataset.push_back(elem);
-            }
+#ifdef SORTCOMPARER_COUNT_OPS
+    (void) options;
+    return -1;
+#else
+    SortAlgoMap<int> sort_algos;              /* Map of algo names to implementation functions */
+    std::vector<BinaryDatasetEntry> entries;  /* Directory of the input file */
+    bool checksummed;                         /* Whether the entries carry checksums */
+    int status = 0;                           /* Exit status of the sorts */
+
+    register_sort_algos(sort_algos);
+
+    auto found = sort_algos.find(options.external.algo);
+    if (found == sort_algos.end()) {
+        std::cerr << "ERROR: Unknown algorithm '" << options.external.algo
+            << "' for --external" << std::endl;
+        return -1;
+    }
 
-            ++position;
-        }
+    if (!is_binary_dataset_file(options.input_path)) {
+        std::cerr << "ERROR: --external reads binary dataset files, convert "
+            << options.input_path << " with --convert first" << std::endl;
+        return -2;
+    }
 
-        datasets.push_back(dataset);
-        
-        std::getline(std::cin, data_str);
-        ++linecount;
+    if (!read_binary_directory(options.input_path, entries, checksummed))
+        return -2;
+
+    std::cout << std::setprecision(3) << std::fixed;
+    std::cout << "==================== EXTERNAL SORT ====================" << std::endl
+        << "Sorting runs with " << found->first << " in "
+        << (options.external.memory_bytes >> 20) << " megabytes of memory" << std::endl;
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        ExternalResult result;
+
+        if (!external_sort_dataset(options.input_path, entries[i], checksummed,
+                found->second.sort, options.external, result))
+            return -2;
+
+        print_external_result(i + 1, found->first, result);
+
+        if (!result.sorted || !result.checksum_ok)
+            status = -3;
     }
 
-    if (errors_occured)
-        std::cerr << std::endl;
+    return status;
+#endif
 }
 
 /*
- * Return whether the sorting algorithm represented by pair1 took less time
- * to execute than the one represented by pair2.
+ * Print what the external sort of the given dataset did, and the times of
+ * its run generation and merge phases.
  */
-bool compare_times (const TimePair& pair1, const TimePair& pair2)
+void print_external_result (int dataset, const std::string& algo,
+    const ExternalResult& result)
 {
-    return pair1.second < pair2.second;
+    std::cout << "DATASET " << dataset << ": " << result.length << " elements in "
+        << result.runs << (result.runs == 1 ? " run" : " runs") << " of up to "
+        << result.run_length << ", merged in " << result.merge_passes
+        << (result.merge_passes == 1 ? " pass" : " passes");
+    if (result.merge_passes > 0)
+        std::cout << " of up to " << result.fan_in << " runs";
+    std::cout << std::endl;
+
+    std::cout << "       run generation " << result.run_ns / 1000.0
+        << " microseconds, of which " << algo << " " << result.sort_ns / 1000.0
+        << std::endl
+        << "       merge " << result.merge_ns / 1000.0 << " microseconds" << std::endl
+        << "       total " << (result.run_ns + result.merge_ns) / 1000.0
+        << " microseconds, " << result.bytes_written / 1048576.0
+        << " megabytes written to temporary files" << std::endl;
+
+    if (result.checksum_ok && result.sorted)
+        std::cout << "       output verified sorted" << std::endl;
+    if (!result.checksum_ok)
+        std::cout << "       ERROR: the input does not match its checksum" << std::endl;
+    if (!result.sorted)
+        std::cout << "       ERROR: the output is not sorted" << std::endl;
 }
 
 /*
- * Sort the given list using the Insertion Sort algorithm.
+ * Parse the command line into the given options. The first argument may
+ * optionally be "results" or "summary" to restrict the output; the remaining
+ * arguments are "--name value" pairs selecting the input and controlling the
+ * timing engine. Return false if any argument is invalid, after notifying the
+ * user of the problem.
  */
-void insertion_sort (std::vector<int> v)
+bool parse_options (int argc, char const *argv[], Options& options)
 {
-    int i, j;  /* Indices */
-    int n;     /* Length of list to sort */
+    int i;             /* Index of the current argument */
+    long long value;   /* Numeric value of the current option */
+
+    options.summary_needed = true;
+    options.results_needed = true;
+    options.benchmark.warmup_runs = 0;
+    options.benchmark.trials = 1;
+    options.benchmark.budget_ns = 0;
+    options.benchmark.timeout_ns = 0;
+    options.benchmark.max_quadratic_n = DEFAULT_MAX_QUADRATIC_N;
+    options.benchmark.k = 0;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    options.element_type = ELEMENT_INT;
+    options.counters = false;
+    options.membench = false;
+    options.format = FORMAT_TEXT;
+    options.output_path = NULL;
+    options.baseline_path = NULL;
+    options.calibration_path = NULL;
+    options.threshold_pct = DEFAULT_THRESHOLD_PCT;
+    options.sweep = false;
+    options.concurrent.jobs = 1;
+    options.concurrent.isolate = false;
+    options.concurrent.numa_local = false;
+    options.simd = SIMD_AVX512;
+    options.external.algo = NULL;
+    options.external.memory_bytes = DEFAULT_EXTERNAL_MEMORY_MB << 20;
+    options.external.temp_dir = std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp";
+    options.sweep_lo = options.sweep_hi = 0;
+    options.input_path = NULL;
+    options.convert_path = NULL;
+
+    i = 1;
 
-    n = v.size();
+    /* Remember which of the summary and/or results the user has requested */
+    if (i < argc && strncmp(argv[i], "--", 2)) {
+        if (!strcmp(argv[i], "results")) {
+            options.summary_needed = false;
+        } else if (!strcmp(argv[i], "summary")) {
+            options.results_needed = false;
+        } else {
+            std::cerr << "ERROR: Invalid program argument, try 'results' or 'summary'"
+                << std::endl;
+            return false;
+        }
 
-    for (i = 1; i < n; ++i) {
-        j = i;
-        while (j > 0 && v[j - 1] > v[j]) {
-            std::swap(v[j], v[j - 1]);
-            --j;
+        ++i;
+    }
+
+    for (; i < argc; ++i) {
+        const char *name = argv[i];  /* Name of the current option */
+        const char *arg;             /* Value following the option name */
+
+        /* Options that take no value */
+        if (!strcmp(name, "--counters")) {
+            options.counters = true;
+            continue;
+        } else if (!strcmp(name, "--membench")) {
+            options.membench = true;
+            continue;
+        } else if (!strcmp(name, "--isolate")) {
+            options.concurrent.isolate = true;
+            continue;
+        } else if (!strcmp(name, "--numa-local")) {
+            options.concurrent.numa_local = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "ERROR: Missing value for option " << name << std::endl;
+            return false;
+        }
+
+        arg = argv[++i];
+
+        if (!strcmp(name, "--input")) {
+            options.input_path = arg;
+        } else if (!strcmp(name, "--generate")) {
+            options.generate_specs.push_back(arg);
+        } else if (!strcmp(name, "--convert")) {
+            options.convert_path = arg;
+        } else if (!strcmp(name, "--warmup")) {
+            if (!parse_option_number(name, arg, value))
+                return false;
+            options.benchmark.warmup_runs = std::min(value, (long long) INT_MAX);
+        } else if (!strcmp(name, "--trials")) {
+            if (!parse_option_number(name, arg, value))
+                return false;
+            options.benchmark.trials = std::min(std::max(value, 1LL), (long long) INT_MAX);
+        } else if (!strcmp(name, "--budget-ms")) {
+            if (!parse_option_number(name, arg, value))
+                return false;
+            options.benchmark.budget_ns = std::min(value, LLONG_MAX / 1000000) * 1000000;
+        } else if (!strcmp(name, "--timeout-ms")) {
+            if (!parse_option_number(name, arg, value))
+                return false;
+            options.benchmark.timeout_ns = std::min(value, LLONG_MAX / 1000000) * 1000000;
+        } else if (!strcmp(name, "--max-quadratic-n")) {
+            if (!parse_option_number(name, arg, value))
+                return false;
+            options.benchmark.max_quadratic_n = std::min(value, (long long) INT_MAX);
+        } else if (!strcmp(name, "--k")) {
+            if (!parse_select_ranks(arg, options.ranks)) {
+                std::cerr << "ERROR: Invalid ranks '" << arg << "' for --k, try 10,1K,1%"
+                    << std::endl;
+                return false;
+            }
+        } else if (!strcmp(name, "--type")) {
+            if (!parse_element_type(arg, options.element_type)) {
+                std::cerr << "ERROR: Unknown element type '" << arg
+                    << "', try int, int64, float, double, record or wide" << std::endl;
+                return false;
+            }
+        } else if (!strcmp(name, "--format")) {
+            if (!parse_output_format(arg, options.format)) {
+                std::cerr << "ERROR: Unknown output format '" << arg
+                    << "', try text, csv or json" << std::endl;
+                return false;
+            }
+        } else if (!strcmp(name, "--output")) {
+            options.output_path = arg;
+        } else if (!strcmp(name, "--baseline")) {
+            options.baseline_path = arg;
+        } else if (!strcmp(name, "--calibration")) {
+            options.calibration_path = arg;
+        } else if (!strcmp(name, "--threshold")) {
+            if (!parse_option_number(name, arg, value))
+                return false;
+            options.threshold_pct = std::min(value, (long long) INT_MAX);
+        } else if (!strcmp(name, "--sweep")) {
+            if (!parse_sweep_range(arg, options.sweep_lo, options.sweep_hi)) {
+                std::cerr << "ERROR: Invalid sweep range '" << arg << "', try 8:26"
+                    << std::endl;
+                return false;
+            }
+            options.sweep = true;
+        } else if (!strcmp(name, "--jobs")) {
+            if (!parse_option_number(name, arg, value))
+                return false;
+            options.concurrent.jobs = std::min(std::max(value, 1LL), (long long) CPU_SETSIZE);
+        } else if (!strcmp(name, "--simd")) {
+            if (!parse_simd_isa(arg, options.simd)) {
+                std::cerr << "ERROR: Unknown instruction set '" << arg
+                    << "', try avx512, avx2 or scalar" << std::endl;
+                return false;
+            }
+        } else if (!strcmp(name, "--external")) {
+            options.external.algo = arg;
+        } else if (!strcmp(name, "--memory-mb")) {
+            if (!parse_option_number(name, arg, value))
+                return false;
+            options.external.memory_bytes = std::min(std::max(value, 1LL), LLONG_MAX >> 20) << 20;
+        } else if (!strcmp(name, "--temp-dir")) {
+            options.external.temp_dir = arg;
+        } else if (!strcmp(name, "--threads")) {
+            if (!parse_option_number(name, arg, value))
+                return false;
+            options.threads = std::min(std::max(value, 1LL), (long long) CPU_SETSIZE);
+        } else {
+            std::cerr << "ERROR: Invalid program option " << name << std::endl;
+            return false;
         }
     }
+
+    /* Performance counters and operation counts cover the whole process, so
+     * they cannot tell concurrent cells apart. */
+    if (options.concurrent.jobs > 1 && options.counters) {
+        std::cerr << "ERROR: --counters cannot be combined with --jobs" << std::endl;
+        return false;
+    }
+
+#ifdef SORTCOMPARER_COUNT_OPS
+    if (options.concurrent.jobs > 1) {
+        std::cerr << "ERROR: --jobs is not available in an instrumented build" << std::endl;
+        return false;
+    }
+
+    if (options.external.algo) {
+        std::cerr << "ERROR: --external is not available in an instrumented build" << std::endl;
+        return false;
+    }
+#endif
+
+    /* The ranks multiply the datasets of a run, which the concurrent cells,
+     * the sweep and the external sort know nothing of. */
+    if (!options.ranks.empty() &&
+            (options.concurrent.jobs > 1 || options.sweep || options.external.algo)) {
+        std::cerr << "ERROR: --k cannot be combined with --jobs, --sweep or --external"
+            << std::endl;
+        return false;
+    }
+
+    /* An external sort streams its datasets from a file, since they need
+     * not fit in memory. */
+    if (options.external.algo && (!options.input_path || !options.generate_specs.empty())) {
+        std::cerr << "ERROR: --external sorts the datasets of an --input file" << std::endl;
+        return false;
+    }
+
+    /* A sweep stops timing each algorithm once its runtime passes a cap,
+     * which is the timeout unless the user set one. */
+    if (options.sweep && options.benchmark.timeout_ns == 0)
+        options.benchmark.timeout_ns = SWEEP_DEFAULT_CAP_NS;
+
+    return true;
+}
+
+/*
+ * Print a description of the accepted command line arguments to stderr.
+ */
+void print_usage ()
+{
+    std::cerr << "USAGE: ./sortcomparer [results OR summary] [options]" << std::endl
+        << "  --input FILE    read datasets from FILE (text or binary) instead of stdin" << std::endl
+        << "  --generate SPEC generate a dataset instead of reading input; may be repeated," << std::endl
+        << "                  e.g. uniform:n=1M, nearly_sorted:n=10M,swaps=1000, zipf:s=1.2" << std::endl
+        << "  --convert FILE  write the input datasets to FILE in binary form and exit" << std::endl
+        << "  --warmup N      untimed runs per algorithm and dataset (default 0)" << std::endl
+        << "  --trials N      timed trials per algorithm and dataset (default 1)" << std::endl
+        << "  --budget-ms MS  keep timing each cell until MS milliseconds are spent" << std::endl
+        << "  --threads N     threads used by the parallel algorithms (default: all)" << std::endl
+        << "  --jobs N        measure cells concurrently on N job workers pinned to CPUs" << std::endl
+        << "  --isolate       give every job worker a physical core to itself" << std::endl
+        << "  --numa-local    copy each dataset to the job worker's memory before sorting" << std::endl
+        << "  --simd ISA      limit the SIMD sorts to avx512, avx2 or scalar code" << std::endl
+        << "  --external ALGO sort each dataset of a binary --input file outside of memory," << std::endl
+        << "                  with ALGO sorting the runs" << std::endl
+        << "  --memory-mb MB  memory an external sort may use (default 256)" << std::endl
+        << "  --temp-dir DIR  directory for the runs of an external sort (default $TMPDIR)" << std::endl
+        << "  --counters      report hardware performance counters for every cell" << std::endl
+        << "  --membench      measure memory bandwidth and latency first, and report every" << std::endl
+        << "                  cell's elements/s per core and fraction of the streaming bound" << std::endl
+        << "  --k K[,K...]    measure the top-k and selection algorithms instead of the" << std::endl
+        << "                  sorts, at each rank K, a count or a percentage of n" << std::endl
+        << "  --type T        sort the datasets as int (default), int64, float, double," << std::endl
+        << "                  record (a 64-bit key with a 64-bit payload) or wide" << std::endl
+        << "                  (a 64-bit key with a 56-byte payload)" << std::endl
+        << "  --format F      export every trial as text (default), csv or json" << std::endl
+        << "  --output FILE   write the csv or json export to FILE instead of stdout" << std::endl
+        << "  --baseline FILE compare every cell with a csv or json export of an earlier run" << std::endl
+        << "  --threshold PCT slowdown over the baseline that fails the run (default 5)" << std::endl
+        << "  --calibration FILE" << std::endl
+        << "                  add Auto Sort, dispatching on the fastest algorithms recorded" << std::endl
+        << "                  in FILE, and record this run's fastest in it" << std::endl
+        << "  --sweep LO:HI   generate the dataset at each length 2^LO to 2^HI, and fit" << std::endl
+        << "                  each algorithm's growth (timeout defaults to 1000 ms)" << std::endl
+        << "  --timeout-ms MS skip or abandon cells taking longer than MS milliseconds" << std::endl
+        << "  --max-quadratic-n N" << std::endl
+        << "                  skip the quadratic sorts on datasets longer than N" << std::endl
+        << "                  (default 200K)" << std::endl;
 }
 
 /*
- * Sort the given list using the Selection Sort algorithm.
+ * Parse the given string as a decimal integer into value. The number may be
+ * followed by a K, M or G suffix to multiply it by a thousand, a million or
+ * a billion. Return whether the whole string was a valid number.
  */
-void selection_sort (std::vector<int> v)
+bool parse_number (const char *str, long long& value)
 {
-    int i, j;  /* Indices */
-    int n;     /* Length of list to sort */
-    int min;   /* Index of minimum element in unsorted sublist */
+    char *end;        /* First character not consumed by the conversion */
+    long long scale;  /* Multiplier given by the suffix */
 
-    n = v.size();
+    errno = 0;
+    value = std::strtoll(str, &end, 10);
 
-    for (i = 0; i < n - 1; ++i) {
-        min = i;
-        for (j = i + 1; j < n; ++j)
-            if (v[j] < v[min])
-                min = j;
+    if (end == str || errno != 0)
+        return false;
 
-        if (min != i)
-            std::swap(v[i], v[min]);
+    switch (*end) {
+    case 'k': case 'K': scale = 1000LL; ++end; break;
+    case 'm': case 'M': scale = 1000000LL; ++end; break;
+    case 'g': case 'G': scale = 1000000000LL; ++end; break;
+    default: scale = 1; break;
     }
+
+    if (*end != '\0' || value > LLONG_MAX / scale || value < LLONG_MIN / scale)
+        return false;
+
+    value *= scale;
+    return true;
 }
 
 /*
- * Sort the given list using the Bubble Sort algorithm.
+ * Parse the given comma-separated list of ranks for the selection
+ * algorithms, each a count of at least 1 or a percentage of the length of
+ * the dataset from 0 to 100 followed by '%', and append them to ranks.
+ * Return whether every rank was valid.
  */
-void bubble_sort (std::vector<int> v)
+bool parse_select_ranks (const char *arg, std::vector<SelectRank>& ranks)
 {
-    int i;         /* Index */
-    int n;         /* Length of list to sort */
-    bool swapped;  /* Indicates whether a swap has occurred on this pass */
+    std::string list(arg);  /* Copy of the list, cut into ranks */
+    std::size_t start = 0;  /* Offset of the current rank */
+    long long count;        /* Value of a rank given as a count */
+    double percent;         /* Value of a rank given as a percentage */
+    char *end;              /* First character not consumed by the conversion */
+
+    while (true) {
+        std::size_t comma = list.find(',', start);
+        std::string item = list.substr(start, comma == std::string::npos ?
+            std::string::npos : comma - start);
+
+        if (!item.empty() && item[item.size() - 1] == '%') {
+            item.erase(item.size() - 1);
+            errno = 0;
+            percent = std::strtod(item.c_str(), &end);
+
+            if (item.empty() || *end != '\0' || errno != 0 || !(percent > 0) ||
+                    percent > 100)
+                return false;
+
+            ranks.push_back(SelectRank{0, percent / 100});
+        } else {
+            if (!parse_number(item.c_str(), count) || count < 1 || count > INT_MAX)
+                return false;
+
+            ranks.push_back(SelectRank{count, 0});
+        }
+
+        if (comma == std::string::npos)
+            return true;
+
+        start = comma + 1;
+    }
+}
+
+/*
+ * Return the rank k that the given rank comes to on a dataset of length n,
+ * from 1 to n, or 0 if the dataset is empty.
+ */
+int resolve_select_rank (const SelectRank& rank, int n)
+{
+    long long k;  /* Rank before it is clamped to the dataset */
+
+    if (n == 0)
+        return 0;
 
-    n = v.size();
-    swapped = true;
+    k = rank.count > 0 ? rank.count : (long long) std::ceil(rank.fraction * n);
+    return std::min((long long) n, std::max(k, 1LL));
+}
+
+/*
+ * Fill datasets with the datasets of the given store in the order they are
+ * to be measured, labels with their descriptions and ranks with the rank k
+ * to select on each. Without any ranks, these are the datasets of the
+ * store with rank 0; with some, every dataset is repeated at each rank in
+ * turn, and its label notes the rank.
+ */
+void expand_select_datasets (const DatasetStore& store,
+    const std::vector<SelectRank>& select_ranks, std::vector<DatasetView>& datasets,
+    std::vector<std::string>& labels, std::vector<int>& ranks)
+{
+    if (select_ranks.empty()) {
+        datasets = store.views;
+        labels = store.labels;
+        ranks.assign(datasets.size(), 0);
+        return;
+    }
 
-    while (swapped) {
-        swapped = false;
+    for (std::size_t i = 0; i < store.views.size(); ++i) {
+        for (std::size_t j = 0; j < select_ranks.size(); ++j) {
+            const int k = resolve_select_rank(select_ranks[j], store.views[i].size);
 
-        for (i = 1; i < n; ++i) {
-            if (v[i - 1] > v[i]) {
-                std::swap(v[i - 1], v[i]);
-                swapped = true;
-            }       
+            datasets.push_back(store.views[i]);
+            labels.push_back((i < store.labels.size() ? store.labels[i] + ", " : "") +
+                "k = " + std::to_string(k));
+            ranks.push_back(k);
         }
     }
 }
 
 /*
- * Sort the given list using the Heap Sort algorithm.
+ * Parse the value of the named option as a non-negative integer, notifying
+ * the user and returning false if it is not one.
  */
-void heap_sort (std::vector<int> v)
+bool parse_option_number (const char *name, const char *arg, long long& value)
 {
-    int i;  /* Index */
-    int n;  /* Length of list to sort */
+    if (!parse_number(arg, value) || value < 0) {
+        std::cerr << "ERROR: Invalid value '" << arg << "' for option " << name
+            << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Print the trial statistics of a cell, or of an algorithm's totals over all
+ * datasets, as an indented line following its ranking in the output.
+ */
+void print_trial_stats (const TrialStats& stats)
+{
+    std::cout << "       min " << stats.min / 1000 << ", median " << stats.median / 1000
+        << ", p90 " << stats.p90 / 1000 << ", p99 " << stats.p99 / 1000
+        << ", stddev " << stats.stddev / 1000 << " microseconds over "
+        << stats.trials << " trials" << std::endl;
+}
+
+/*
+ * Print the performance counter values of a cell, or of an algorithm's
+ * totals over all datasets, as an indented line following its ranking in
+ * the output. Instructions per cycle are derived when both are counted, and
+ * events that could not be counted are shown as n/a.
+ */
+void print_counter_values (const CounterValues& values)
+{
+    std::cout << "      ";
+
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        std::cout << " " << counter_name(i) << " ";
 
-    n = v.size();
+        if (values.valid[i])
+            std::cout << (long long) values.counts[i];
+        else
+            std::cout << "n/a";
+
+        if (i == COUNTER_INSTRUCTIONS) {
+            std::cout << ", IPC ";
 
-    for (i = n / 2 - 1; i >= 0; --i)
-        max_heapify(v, n, i);
+            if (values.valid[COUNTER_CYCLES] && values.valid[COUNTER_INSTRUCTIONS] &&
+                    values.counts[COUNTER_CYCLES] > 0)
+                std::cout << values.counts[COUNTER_INSTRUCTIONS] / values.counts[COUNTER_CYCLES];
+            else
+                std::cout << "n/a";
+        }
 
-    for (i = n - 1; i >= 0; --i) {
-        std::swap(v[0], v[i]);
-        max_heapify(v, i, 0);
+        if (i + 1 < NUM_COUNTERS)
+            std::cout << ",";
     }
+
+    std::cout << std::endl;
+}
+
+/*
+ * Print the operation counts of a cell, or of an algorithm's totals over all
+ * datasets, as an indented line following its ranking in the output. Each
+ * count is also given as a multiple of the given n log2(n) bound, or of the
+ * bounds of all datasets summed.
+ */
+void print_op_counts (const OpCounts& ops, double bound)
+{
+    std::cout << "       comparisons " << (long long) ops.comparisons << " ("
+        << ops.comparisons / bound << " n log2 n), swaps " << (long long) ops.swaps
+        << " (" << ops.swaps / bound << " n log2 n), writes " << (long long) ops.writes
+        << " (" << ops.writes / bound << " n log2 n)" << std::endl;
 }
 
 /*
- * Helper function for Heap Sort that constructs a max heap rooted at index i 
- * in the provided list of size n, assuming the binary trees rooted at i's 
- * left and right children are already max heaps.
+ * Print why the given cell has no measurement, in place of its runtime.
  */
-void max_heapify (std::vector<int>& v, int n, int i)
+void print_cell_status (const CellResult& cell)
 {
-    int largest;  /* Index of largest list value among v[i] and its children */
-    int left;     /* Index of v[i]'s left child, if it exists */
-    int right;    /* Index of v[i]'s right child, if it exists */
-
-    largest = i;
-    left = 2 * i + 1;
-    right = 2 * i + 2;
-
-    if (left < n && v[left] > v[i])
-        largest = left;
-    if (right < n && v[right] > v[largest])
-        largest = right;
-
-    /* If v[i] is larger than its two children, then the max heap construction
-     * is done. Otherwise, we need to swap v[i] with the larger of its two 
-     * children and repeat the process on the subtree rooted there. */
-    if (largest != i) {
-        std::swap(v[i], v[largest]);
-        max_heapify(v, n, largest);
+    switch (cell.status) {
+    case CELL_SKIPPED_SIZE:
+        std::cout << "skipped (quadratic algorithm on a dataset above --max-quadratic-n)";
+        break;
+    case CELL_SKIPPED_ESTIMATE:
+        std::cout << "skipped (estimated " << cell.estimate_ns / 1000
+            << " microseconds exceeds the timeout)";
+        break;
+    case CELL_ABORTED:
+        std::cout << "aborted (a run exceeded the timeout after "
+            << cell.stats.trials << " timed trials)";
+        break;
+    case CELL_UNSORTED:
+        std::cout << "FAILED (the output is not sorted)";
+        break;
+    case CELL_CORRUPTED:
+        std::cout << "FAILED (the output is not a permutation of the dataset)";
+        break;
+    default:
+        break;
     }
+
+    std::cout << std::endl;
 }
 
 /*
- * Sort the given list using the Merge Sort algorithm.
+ * Print the rate of the given number of elements sorted in the given time,
+ * per core of the given number of threads, and the fraction of the given
+ * streaming bound that the time reaches.
  */
-void merge_sort (std::vector<int> v)
+void print_throughput (double elements, double time_ns, int threads, double streaming_ns)
 {
-    merge_sort_sublist(v, 0, v.size() - 1);
+    std::cout << "       " << elements * 1000 / std::max(time_ns, 1.0) / threads
+        << " million elements/s per core, " << 100 * streaming_ns / std::max(time_ns, 1.0)
+        << "% of the streaming bound" << std::endl;
 }
 
 /*
- * Helper function for Merge Sort that sorts the sublist of the given list 
- * with the specified start and end indices, using the Merge Sort algorithm.
+ * Print the bandwidths and latencies of the given memory profile, and the
+ * memcpy throughput at the size of each of the given datasets, with the
+ * streaming bound it gives a sort of the dataset.
  */
-void merge_sort_sublist (std::vector<int>& v, int start, int end)
+void print_memory_profile (const MemoryProfile& profile,
+    const std::vector<DatasetView>& datasets, const std::vector<double>& copy_gbps,
+    int element_size)
 {
-    int middle;  /* Middle index of the sublist */
+    std::cout << "Sequential read " << profile.read_gbps << " GB/s, write "
+        << profile.write_gbps << " GB/s over " << (profile.buffer_bytes >> 20) << " MiB"
+        << std::endl;
+
+    std::cout << "Random load latency:";
+    for (int level = 0; level < NUM_LATENCY_LEVELS; ++level) {
+        std::cout << (level ? ", " : " ") << latency_level_name(level) << " ";
 
-    if (start < end) {
-        middle = start + ((end - start) / 2);
-        merge_sort_sublist(v, start, middle);
-        merge_sort_sublist(v, middle + 1, end);
-        merge_sublists(v, start, middle, end);
+        if (profile.latency_bytes[level])
+            std::cout << profile.latency_ns[level] << " ns in "
+                << (profile.latency_bytes[level] >> 10) << " KiB";
+        else
+            std::cout << "n/a";
     }
+    std::cout << std::endl;
+
+    for (std::size_t i = 0; i < datasets.size(); ++i) {
+        const double bytes = (double) datasets[i].size * element_size;
+
+        std::cout << "memcpy of dataset " << (i + 1) << ", " << (long long) bytes
+            << " bytes: " << copy_gbps[i] << " GB/s, a streaming bound of "
+            << (copy_gbps[i] > 0 ? bytes / copy_gbps[i] / 1000 : 0) << " microseconds"
+            << std::endl;
+    }
+
+    std::cout << std::endl;
 }
 
 /*
- * Helper function for Merge Sort that sorts v[start..end] by merging the two 
- * sorted sublists v[start..middle] and v[middle + 1..end] into a single 
- * sorted list.
+ * Print the feature class of each dataset with the fastest algorithm
+ * measured on it, and Auto Sort's time relative to that algorithm's.
  */
-void merge_sublists (std::vector<int>& v, int start, int middle, int end)
+void print_calibration (const std::vector<DatasetCalibration>& calibrations)
 {
-    int i;   /* Index into first initial sublist */
-    int j;   /* Index into second initial sublist */
-    int k;   /* Index into final merged sublist */
-    int n1;  /* Length of first initial sublist */
-    int n2;  /* Length of second initial sublist */
-
-    n1 = middle - start + 1;
-    n2 = end - middle;
-
-    int left_sublist[n1];
-    int right_sublist[n2];
-
-    /* Initialize the two auxiliary sublists with the proper elements from 
-     * the initial state of v[start..end]. */
-    for (i = 0; i < n1; ++i)
-        left_sublist[i] = v[start + i];
-    for (j = 0; j < n2; ++j)
-        right_sublist[j] = v[middle + 1 + j];
-
-    i = 0;
-    j = 0;
-    k = start;
-
-    /* Begin merging by repeatedly assigning the lesser of the two elements at
-     * the front of either sublist to the proper position in v. */
-    while (i < n1 && j < n2) {
-        if (left_sublist[i] <= right_sublist[j])
-            v[k++] = left_sublist[i++];
-        else
-            v[k++] = right_sublist[j++];
+    double fastest_total = 0;  /* Sum of the fastest times where both were measured */
+    double auto_total = 0;     /* Sum of Auto Sort's times on the same datasets */
+
+    for (std::size_t i = 0; i < calibrations.size(); ++i) {
+        const DatasetCalibration& calibration = calibrations[i];
+
+        std::cout << "DATASET " << (i + 1) << " (";
+        describe_feature_class(calibration.features, std::cout);
+        std::cout << "):" << std::endl;
+
+        if (calibration.fastest.empty()) {
+            std::cout << "No algorithm was measured in full" << std::endl << std::endl;
+            continue;
+        }
+
+        std::cout << "Fastest: " << calibration.fastest << ", "
+            << calibration.fastest_ns / 1000 << " microseconds" << std::endl;
+
+        if (calibration.auto_ns > 0) {
+            std::cout << AUTO_SORT_NAME << ": " << calibration.auto_ns / 1000
+                << " microseconds, " << calibration.auto_ns / calibration.fastest_ns
+                << "x the fastest, probe included" << std::endl;
+
+            fastest_total += calibration.fastest_ns;
+            auto_total += calibration.auto_ns;
+        }
+
+        std::cout << std::endl;
+    }
+
+    if (auto_total > 0)
+        std::cout << AUTO_SORT_NAME << " took " << auto_total / fastest_total
+            << "x the time of the fastest algorithm on each dataset" << std::endl
+            << std::endl;
+}
+
+/*
+ * Print the given comparisons with the baseline, grouped by dataset with
+ * the slowest cells relative to the baseline first, if print is set, and
+ * return the number of cells that regressed.
+ */
+int print_baseline_comparisons (std::vector<CellComparison>& comparisons, bool print)
+{
+    int regressed = 0;  /* Number of cells that regressed */
+    int dataset = 0;    /* Dataset whose comparisons are being printed */
+
+    std::sort(comparisons.begin(), comparisons.end(), compare_comparisons);
+
+    for (std::size_t i = 0; i < comparisons.size(); ++i) {
+        const BaselineComparison& comparison = comparisons[i].comparison;
+
+        if (comparison.regressed)
+            ++regressed;
+
+        if (!print)
+            continue;
+
+        if (comparisons[i].dataset != dataset) {
+            if (dataset)
+                std::cout << std::endl;
+            dataset = comparisons[i].dataset;
+            std::cout << "DATASET " << dataset << ":" << std::endl;
+        }
+
+        std::cout << comparisons[i].algo << ": " << comparison.ratio
+            << "x the baseline time";
+
+        if (comparison.tested) {
+            std::cout << " (95% CI " << comparison.ratio_lo << "x to "
+                << comparison.ratio_hi << "x, p " << comparison.p_value << ")";
+            if (comparison.regressed)
+                std::cout << ", REGRESSION";
+        } else {
+            std::cout << " (too few trials to test, use --trials "
+                << BASELINE_MIN_TRIALS << " or more)";
+        }
+
+        std::cout << std::endl;
     }
 
-    /* If elements remain in the left sublist that have not yet been added to
-     * v, add them now. */
-    while (i < n1)
-        v[k++] = left_sublist[i++];
+    if (print)
+        std::cout << std::endl;
 
-    /* Otherwise, add the rest of the elements in the right sublist to v. */
-    while (j < n2)
-        v[k++] = right_sublist[j++];
+    return regressed;
 }
 
 /*
- * Sort the given list using the Quick Sort algorithm.
+ * Print the given checks of cells measured concurrently against the same
+ * cells measured serially, followed by the number of cells that were
+ * significantly slower when measured concurrently and the number that had
+ * too few trials to be tested.
  */
-void quick_sort (std::vector<int> v)
+void print_interference_checks (const std::vector<InterferenceCheck>& checks)
 {
-    quick_sort_sublist(v, 0, v.size() - 1);
+    int slowed = 0;    /* Number of cells slowed by running concurrently */
+    int untested = 0;  /* Number of cells with too few trials to test */
+
+    for (std::size_t i = 0; i < checks.size(); ++i) {
+        const BaselineComparison& comparison = checks[i].comparison;
+
+        std::cout << checks[i].algo << " on dataset " << checks[i].dataset << ": "
+            << comparison.ratio << "x its serial time";
+
+        if (comparison.tested) {
+            std::cout << " (95% CI " << comparison.ratio_lo << "x to "
+                << comparison.ratio_hi << "x, p " << comparison.p_value << ")";
+            if (comparison.regressed) {
+                std::cout << ", INTERFERENCE";
+                ++slowed;
+            }
+        } else {
+            std::cout << " (too few trials to test, use --trials "
+                << BASELINE_MIN_TRIALS << " or more)";
+            ++untested;
+        }
+
+        std::cout << std::endl;
+    }
+
+    std::cout << slowed << " of " << checks.size() << " cells measured again serially "
+        "were significantly slower concurrently";
+    if (untested)
+        std::cout << ", and " << untested << " had too few trials to test, use --trials "
+            << BASELINE_MIN_TRIALS << " or more";
+    std::cout << std::endl << std::endl;
 }
 
 /*
- * Helper function for Quick Sort that sorts the sublist of the given list 
- * with the specified start and end indices, using the Quick Sort algorithm.
+ * Print the table of the given algorithm's cells over the datasets of a
+ * sweep: the power law fitted to its measured times, then for each length
+ * its median time, time per element and the smallest cache holding its
+ * elements, or why it was not measured.
  */
-void quick_sort_sublist (std::vector<int>& v, int start, int end)
+void print_sweep_table (const std::string& algo, const std::vector<CellResult>& cells,
+    const std::vector<DatasetView>& datasets, int element_size, const CacheSizes& caches)
 {
-    int middle;  /* Middle index of the sublist */
+    std::vector<double> ns;     /* Lengths of the measured datasets */
+    std::vector<double> times;  /* Median times of the measured datasets */
+    double exponent, constant;  /* Fitted power law */
+
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+        if (cells[i].status != CELL_MEASURED)
+            continue;
 
-    if (start < end) {
-        middle = partition_sublist(v, start, end);
-        quick_sort_sublist(v, start, middle - 1);
-        quick_sort_sublist(v, middle + 1, end);
+        ns.push_back(datasets[i].size);
+        times.push_back(cells[i].stats.median);
     }
+
+    std::cout << algo << ": ";
+
+    if (fit_power_law(ns, times, exponent, constant))
+        std::cout << "time " << constant << " n^" << exponent
+            << " nanoseconds, fitted over n = " << (long long) ns.front() << " to "
+            << (long long) ns.back() << std::endl;
+    else
+        std::cout << "too few lengths measured to fit a power law" << std::endl;
+
+    std::cout << std::setw(12) << "n" << std::setw(16) << "microseconds"
+        << std::setw(14) << "ns/element" << "  fits in" << std::endl;
+
+    for (std::size_t i = 0; i < cells.size(); ++i) {
+        const int n = datasets[i].size;
+
+        std::cout << std::setw(12) << n;
+
+        if (cells[i].status != CELL_MEASURED) {
+            std::cout << "  ";
+            print_cell_status(cells[i]);
+            continue;
+        }
+
+        std::cout << std::setw(16) << cells[i].stats.median / 1000 << std::setw(14)
+            << cells[i].stats.median / std::max(n, 1) << "  "
+            << cache_level_name((long long) n * element_size, caches) << std::endl;
+    }
+
+    std::cout << std::endl;
 }
 
 /*
- * Helper function for Quick Sort that partitions v[start..end] into two
- * sublists, the first with all elements less than or equal to a chosen pivot
- * element (in this case, the initial element at v[end]), and the rest with
- * all elements greater than this pivot element. Return the index of the end 
- * of the end of the first sublist.
+ * Return whether comparison c1 is printed before c2: it is on an earlier
+ * dataset, or on the same dataset and slower relative to the baseline.
  */
-int partition_sublist (std::vector<int>& v, int start, int end)
+bool compare_comparisons (const CellComparison& c1, const CellComparison& c2)
 {
-    int i;  /* Last index of sublist of elements found to be the pivot */
-    int j;  /* First index of sublist of elements yet to be examined */
+    if (c1.dataset != c2.dataset)
+        return c1.dataset < c2.dataset;
 
-    i = start - 1;
-    
-    for (j = start; j < end; ++j)
-        if (v[j] <= v[end])
-            std::swap(v[++i], v[j]);
+    return c1.comparison.ratio > c2.comparison.ratio;
+}
 
-    std::swap(v[++i], v[end]);
-    return i;
+/*
+ * Return whether the sorting algorithm represented by pair1 took less time
+ * to execute than the one represented by pair2.
+ */
+bool compare_times (const TimePair& pair1, const TimePair& pair2)
+{
+    return pair1.second < pair2.second;
 }
 
 /*
- * Sort the given list using the Shell Sort algorithm, with Donald Shell's
- * original proposed gap size sequence (n / 2, n / 4, n / 8, etc).
+ * Return whether the sorting algorithm represented by pair1 ranks ahead of
+ * the one represented by pair2 in the summary: it was measured on more
+ * datasets, or on as many in less total time.
  */
-void shell_sort (std::vector<int> v)
+bool compare_totals (const TotalPair& pair1, const TotalPair& pair2)
 {
-    int i, j;  /* Indices */
-    int gap;   /* Distance between elements being compared */
-    int n;     /* Length of list to sort */
+    if (pair1.second.measured != pair2.second.measured)
+        return pair1.second.measured > pair2.second.measured;
+
+    return pair1.second.stats.median < pair2.second.stats.median;
+}
+
+/*
+ * Return whether the sorting algorithm represented by pair1 is listed in a
+ * class of the summary ahead of the one represented by pair2: the stable
+ * algorithms come first, then the unstable ones, then those whose
+ * stability could not be seen.
+ */
+bool compare_stability (const TotalPair& pair1, const TotalPair& pair2)
+{
+    return stability_rank(pair1.second.stability) < stability_rank(pair2.second.stability);
+}
 
-    n = v.size();
+/*
+ * Return the position of the class of algorithms with the given stability
+ * in the summary.
+ */
+int stability_rank (Stability stability)
+{
+    switch (stability) {
+    case STABILITY_KEPT:
+        return 0;
+    case STABILITY_BROKEN:
+        return 1;
+    case STABILITY_UNTESTED:
+    default:
+        return 2;
+    }
+}
 
-    for (gap = n / 2; gap > 0; gap /= 2)
-        for (i = gap; i < n; ++i)
-            for (j = i; j >= gap && v[j - gap] > v[j]; j -= gap)
-                std::swap(v[j], v[j - gap]);
+/*
+ * Return the heading of the class of algorithms with the given stability
+ * in the summary.
+ */
+const char *stability_heading (Stability stability)
+{
+    switch (stability) {
+    case STABILITY_KEPT:
+        return "Stable (equal keys kept in order on every dataset):";
+    case STABILITY_BROKEN:
+        return "Unstable (equal keys reordered on some dataset):";
+    case STABILITY_UNTESTED:
+    default:
+        return "Stability unknown (no equal keys in the datasets sorted):";
+    }
 }
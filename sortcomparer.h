@@ -21,6 +21,51 @@
  * average and total time performance for each algorithm. Supplying no
  * arguments will print both, with the individual results following the 
  * summary.
+ *
+ * Options following these arguments control how each algorithm is timed:
+ * "--warmup N" performs N untimed runs first, "--trials N" takes N timed
+ * trials, and "--budget-ms MS" keeps adding trials until MS milliseconds have
+ * been measured. With more than one trial, percentile statistics are printed
+ * beneath each time. "--threads N" sets the number of threads used by the
+ * parallel algorithms. "--max-quadratic-n N" skips the quadratic algorithms
+ * on datasets longer than N, and "--timeout-ms MS" skips cells predicted to
+ * take longer than MS milliseconds and abandons those that do, so that the
+ * remaining algorithms can still be compared on large datasets. "--type T"
+ * sorts the datasets as elements of type int (the default), int64, float,
+ * double, record, a 16-byte key with a payload, or wide, a key with a
+ * payload filling a 64-byte cache line. Records carry their original
+ * positions, so each algorithm is found stable or unstable from its output
+ * and ranked in the summary among the algorithms of its class, and wide
+ * records are also sorted indirectly, through pointers. "--counters" adds
+ * the hardware performance counters of each cell beneath its time, and
+ * "--membench" measures memory bandwidth, load latency and memcpy at each
+ * dataset's size first, and adds each cell's elements per second per core
+ * and the fraction of its streaming bound it reaches. A build made with
+ * "make counted" also prints the comparisons, swaps and writes of each.
+ * "--format csv" or "--format json" streams every trial of every cell, with
+ * the metadata of the run, to stdout in place of the text output, or to the
+ * file given by "--output FILE" alongside it. "--baseline FILE" compares
+ * every cell with the same cell of such an export, and exits with a nonzero
+ * status if any is significantly slower by more than "--threshold PCT"
+ * percent. "--sweep LO:HI" generates the dataset at every power of two
+ * length from 2^LO to 2^HI and adds a table of each algorithm's times as n
+ * grows, with a fitted power law and the cache each length fits in.
+ * "--jobs N" measures cells concurrently on N job workers pinned to their
+ * own CPUs ("--isolate" keeps them on separate physical cores, and
+ * "--numa-local" copies each dataset to its worker), and measures a sample
+ * of the cells again serially to flag any slowed by the concurrency.
+ * "--simd ISA" limits the vectorized int sorts to avx512, avx2 or scalar
+ * code, instead of the widest instruction set the CPU supports.
+ * "--external ALGO" instead sorts each dataset of a binary input file
+ * outside of memory, in sorted runs spilled to "--temp-dir DIR" and then
+ * merged, using at most "--memory-mb MB" megabytes, and prints the times
+ * of run generation and of merging. "--k K" measures the top-k and
+ * selection algorithms, beside std::partial_sort and std::nth_element, in
+ * place of the sorts, at each of a comma-separated list of ranks K, each a
+ * count or a percentage of the dataset's length. "--calibration FILE" adds
+ * Auto Sort, which probes each dataset's features and sorts it with the
+ * algorithm recorded in FILE as fastest on similar datasets, and records
+ * the fastest algorithm on each dataset of the run in FILE.
  */
 
 #ifndef SORTCOMPARER_H
@@ -28,40 +73,152 @@
 
 /* include statements */
 #include <algorithm>
-#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <unordered_map>
-#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "autosort.h"
+#include "benchmark.h"
+#include "concurrent.h"
+#include "datasetio.h"
+#include "elementtypes.h"
+#include "externalsort.h"
+#include "generator.h"
+#include "membench.h"
+#include "perfcounters.h"
+#include "registry.h"
+#include "regression.h"
+#include "resultexport.h"
+#include "scratcharena.h"
+#include "simdsort.h"
+#include "sweep.h"
+#include "threadpool.h"
+
+/* An algorithm's totals over the datasets it was measured on */
+struct AlgoTotals {
+    TrialStats stats;        /* Sum of the statistics of the measured cells */
+    CounterValues counters;  /* Sum of the mean counts of the measured cells */
+    OpCounts ops;            /* Sum of the mean operations of the measured cells */
+    double bound;            /* Sum of n log2(n) over the measured cells */
+    double elements;         /* Sum of n over the measured cells */
+    double streaming_ns;     /* Sum of the streaming bounds of the measured cells */
+    int measured;            /* Number of datasets measured in full */
+    int skipped;             /* Number of datasets skipped or aborted */
+    int failed;              /* Number of datasets failing verification */
+    Stability stability;     /* What the outputs showed about its stability */
+};
+
+/* A cell whose output failed verification */
+struct CellFailure {
+    std::string algo;                 /* Name of the algorithm */
+    int dataset;                      /* Index of the dataset */
+    CellStatus status;                /* How the output was wrong */
+};
+
+/* A cell of the run compared with the same cell of the baseline */
+struct CellComparison {
+    std::string algo;                 /* Name of the algorithm */
+    int dataset;                      /* Index of the dataset */
+    BaselineComparison comparison;    /* Outcome of the comparison */
+};
+
+/* A rank for the top-k and selection algorithms, given as a count or as a
+ * fraction of the length of each dataset */
+struct SelectRank {
+    long long count;                  /* Number of elements, or 0 for a fraction */
+    double fraction;                  /* Fraction of the length, if count is 0 */
+};
+
+/* The fastest algorithm measured on a dataset, for the calibration table,
+ * and Auto Sort's time on the same dataset */
+struct DatasetCalibration {
+    FeatureClass features;            /* Class of the dataset */
+    std::string fastest;              /* Name of the fastest algorithm, or empty */
+    double fastest_ns;                /* Its median time in nanoseconds */
+    double auto_ns;                   /* Median time of Auto Sort, or 0 if not measured */
+};
+
 /* using declarations */
-using Clock = std::chrono::high_resolution_clock;
-using DatasetList = std::vector< std::vector<int> >;
-using ResultTimesMap = std::unordered_map<std::string, std::vector<long long> >;
-using SortAlgoMap = std::unordered_map<std::string, void (*) (std::vector<int>)>;
-using TotalTimeMap = std::unordered_map<std::string,long long>;
-using TimePair = std::pair<std::string,long long>;
+using ResultTimesMap = std::unordered_map<std::string, std::vector<CellResult> >;
+using TotalTimeMap = std::unordered_map<std::string,AlgoTotals>;
+using HistoryMap = std::unordered_map<std::string, RunHistory>;
+using TimePair = std::pair<std::string,double>;
+using TotalPair = std::pair<std::string,AlgoTotals>;
 
-/* function declarations */
-void insertion_sort (std::vector<int> v);
-void selection_sort (std::vector<int> v);
-void bubble_sort (std::vector<int> v);
-void heap_sort (std::vector<int> v);
-void merge_sort (std::vector<int> v);
-void quick_sort (std::vector<int> v);
-void shell_sort (std::vector<int> v);
+/* Settings parsed from the command line */
+struct Options {
+    bool summary_needed;         /* Whether to print the SUMMARY section */
+    bool results_needed;         /* Whether to print the RESULTS section */
+    BenchmarkOptions benchmark;  /* Warmup, trial and budget settings */
+    int threads;                 /* Threads in the pool used by parallel sorts */
+    ConcurrentOptions concurrent;  /* Number and placement of the job workers */
+    SimdIsa simd;                /* Widest instruction set the SIMD sorts may use */
+    ExternalOptions external;    /* Algorithm and memory of an external sort */
+    ElementType element_type;    /* Type of the elements the datasets are sorted as */
+    bool counters;               /* Whether to report performance counters */
+    bool membench;               /* Whether to measure the memory before the run */
+    OutputFormat format;         /* Format that measurements are exported in */
+    const char *output_path;     /* File to export measurements to, or NULL for stdout */
+    const char *baseline_path;   /* Export to compare the run with, or NULL */
+    const char *calibration_path;  /* Calibration table of Auto Sort, or NULL */
+    int threshold_pct;           /* Slowdown in percent that counts as a regression */
+    bool sweep;                  /* Whether to sweep the dataset length */
+    int sweep_lo;                /* Smallest power of two length of the sweep */
+    int sweep_hi;                /* Largest power of two length of the sweep */
+    const char *input_path;      /* File to read datasets from, or NULL for stdin */
+    const char *convert_path;    /* Binary file to convert the input into, or NULL */
+    std::vector<const char *> generate_specs;  /* Specs of datasets to generate */
+    std::vector<SelectRank> ranks;             /* Ranks to select at, or none to sort */
+};
 
-void read_in_datasets (DatasetList& datasets);
+/* constants */
+const int DEFAULT_MAX_QUADRATIC_N = 200000;  /* Default size cap of the quadratic sorts */
+const int DEFAULT_THRESHOLD_PCT = 5;         /* Default slowdown counted as a regression */
+
+/* function declarations */
+template <typename T>
+int run_benchmark (const Options& options, const DatasetStore& store,
+    const PerfCounters *counters);
+int run_external_sort (const Options& options);
+void print_external_result (int dataset, const std::string& algo,
+    const ExternalResult& result);
+bool parse_options (int argc, char const *argv[], Options& options);
+void print_usage ();
+bool parse_select_ranks (const char *arg, std::vector<SelectRank>& ranks);
+int resolve_select_rank (const SelectRank& rank, int n);
+void expand_select_datasets (const DatasetStore& store,
+    const std::vector<SelectRank>& select_ranks, std::vector<DatasetView>& datasets,
+    std::vector<std::string>& labels, std::vector<int>& ranks);
+bool parse_number (const char *str, long long& value);
+bool parse_option_number (const char *name, const char *arg, long long& value);
+void print_trial_stats (const TrialStats& stats);
+void print_counter_values (const CounterValues& values);
+void print_op_counts (const OpCounts& ops, double bound);
+void print_throughput (double elements, double time_ns, int threads, double streaming_ns);
+void print_memory_profile (const MemoryProfile& profile,
+    const std::vector<DatasetView>& datasets, const std::vector<double>& copy_gbps,
+    int element_size);
+void print_cell_status (const CellResult& cell);
+void print_calibration (const std::vector<DatasetCalibration>& calibrations);
+int print_baseline_comparisons (std::vector<CellComparison>& comparisons, bool print);
+bool compare_comparisons (const CellComparison& c1, const CellComparison& c2);
+void print_interference_checks (const std::vector<InterferenceCheck>& checks);
+void print_sweep_table (const std::string& algo, const std::vector<CellResult>& cells,
+    const std::vector<DatasetView>& datasets, int element_size, const CacheSizes& caches);
 bool compare_times (const TimePair& pair1, const TimePair& pair2);
-void max_heapify (std::vector<int>& v, int n, int i);
-void merge_sort_sublist (std::vector<int>& v, int left, int right);
-void merge_sublists (std::vector<int>& v, int start, int middle, int end);
-void quick_sort_sublist (std::vector<int>& v, int start, int end);
-int partition_sublist (std::vector<int>& v, int start, int end);
+bool compare_totals (const TotalPair& pair1, const TotalPair& pair2);
+bool compare_stability (const TotalPair& pair1, const TotalPair& pair2);
+int stability_rank (Stability stability);
+const char *stability_heading (Stability stability);
 
 #endif // SORTCOMPARER_H
@@ -0,0 +1,150 @@
+/**
+ * Scaling sweeps. With --sweep LO:HI, the generated dataset is repeated at
+ * every power of two length from 2^LO to 2^HI, so that each algorithm's
+ * runtime can be followed as n grows. A power law t = c n^k is fitted to
+ * each algorithm's times by least squares on their logarithms, and each
+ * length is marked with the smallest cache its working set fits in, using
+ * the cache sizes reported by the C library or, failing that, by sysfs.
+ */
+
+#include "sweep.h"
+
+/*
+ * Parse the given "LO:HI" sweep range of powers of two into lo and hi.
+ * Return whether it is a valid range within 0..SWEEP_MAX_EXPONENT.
+ */
+bool parse_sweep_range (const char *arg, int& lo, int& hi)
+{
+    char *end;  /* First character not consumed by a conversion */
+
+    lo = std::strtol(arg, &end, 10);
+    if (end == arg || *end != ':')
+        return false;
+
+    const char *rest = end + 1;
+    hi = std::strtol(rest, &end, 10);
+    if (end == rest || *end != '\0')
+        return false;
+
+    return lo >= 0 && lo <= hi && hi <= SWEEP_MAX_EXPONENT;
+}
+
+/*
+ * Append to specs one generator spec for each power of two length from 2^lo
+ * to 2^hi, each the given base spec with its length replaced.
+ */
+void expand_sweep_specs (const char *base, int lo, int hi, std::vector<std::string>& specs)
+{
+    std::string str(base);
+    const char *separator = str.find(':') == std::string::npos ? ":" : ",";
+
+    for (int e = lo; e <= hi; ++e)
+        specs.push_back(str + separator + "n=" + std::to_string(1LL << e));
+}
+
+/*
+ * Fit the power law time = constant * n^exponent to the given lengths and
+ * times by least squares on their logarithms. Return false if there are
+ * fewer than two distinct lengths to fit.
+ */
+bool fit_power_law (const std::vector<double>& ns, const std::vector<double>& times,
+    double& exponent, double& constant)
+{
+    const int count = ns.size();
+    double sum_x = 0, sum_y = 0;  /* Sums of the logarithms */
+    double sum_xx = 0, sum_xy = 0;
+
+    for (int i = 0; i < count; ++i) {
+        double x = std::log(ns[i]);
+        double y = std::log(std::max(times[i], 1.0));
+
+        sum_x += x;
+        sum_y += y;
+        sum_xx += x * x;
+        sum_xy += x * y;
+    }
+
+    double denominator = count * sum_xx - sum_x * sum_x;
+    if (count < 2 || denominator <= 1e-12)
+        return false;
+
+    exponent = (count * sum_xy - sum_x * sum_y) / denominator;
+    constant = std::exp((sum_y - exponent * sum_x) / count);
+    return true;
+}
+
+/*
+ * Find the data cache sizes of the machine into caches.
+ */
+void detect_cache_sizes (CacheSizes& caches)
+{
+    caches.l1d = caches.l2 = caches.llc = 0;
+
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    caches.l1d = std::max(sysconf(_SC_LEVEL1_DCACHE_SIZE), 0L);
+    caches.l2 = std::max(sysconf(_SC_LEVEL2_CACHE_SIZE), 0L);
+    caches.llc = std::max(sysconf(_SC_LEVEL3_CACHE_SIZE), 0L);
+#endif
+
+    if (caches.l1d == 0)
+        caches.l1d = read_sysfs_cache_size(1, true);
+    if (caches.l2 == 0)
+        caches.l2 = read_sysfs_cache_size(2, false);
+    if (caches.llc == 0)
+        caches.llc = read_sysfs_cache_size(3, false);
+
+    /* Without a level 3 cache, the level 2 cache is the last level */
+    if (caches.llc == 0)
+        caches.llc = caches.l2;
+}
+
+/*
+ * Return the size in bytes of the first CPU's cache at the given level, a
+ * data or unified cache if data is set and a unified one otherwise, as
+ * reported by sysfs, or 0 if there is none.
+ */
+long long read_sysfs_cache_size (int level, bool data)
+{
+    for (int index = 0; index < 8; ++index) {
+        std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" +
+            std::to_string(index) + "/";
+        std::ifstream level_file(dir + "level"), type_file(dir + "type"),
+            size_file(dir + "size");
+        int cache_level;
+        std::string type, size;
+
+        if (!(level_file >> cache_level) || !(type_file >> type) || !(size_file >> size))
+            break;
+
+        if (cache_level != level || !(type == "Unified" || (data && type == "Data")))
+            continue;
+
+        long long bytes = std::atoll(size.c_str());
+        switch (size.empty() ? '\0' : size[size.size() - 1]) {
+        case 'K': bytes <<= 10; break;
+        case 'M': bytes <<= 20; break;
+        case 'G': bytes <<= 30; break;
+        default: break;
+        }
+
+        return bytes;
+    }
+
+    return 0;
+}
+
+/*
+ * Return the name of the smallest cache that a working set of the given
+ * number of bytes fits in, or "memory" if it fits in none of them.
+ */
+const char *cache_level_name (long long bytes, const CacheSizes& caches)
+{
+    if (bytes <= caches.l1d)
+        return "L1d";
+    if (bytes <= caches.l2)
+        return "L2";
+    if (bytes <= caches.llc)
+        return "LLC";
+
+    return "memory";
+}
@@ -0,0 +1,43 @@
+/**
+ * Scaling sweeps. With --sweep LO:HI, the generated dataset is repeated at
+ * every power of two length from 2^LO to 2^HI, so that each algorithm's
+ * runtime can be followed as n grows. A power law t = c n^k is fitted to
+ * each algorithm's times by least squares on their logarithms, and each
+ * length is marked with the smallest cache its working set fits in, using
+ * the cache sizes reported by the C library or, failing that, by sysfs.
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+/* include statements */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+/* The data cache sizes of the machine in bytes, 0 where unknown */
+struct CacheSizes {
+    long long l1d;  /* Level 1 data cache of one core */
+    long long l2;   /* Level 2 cache */
+    long long llc;  /* Last level cache */
+};
+
+/* constants */
+const int SWEEP_MAX_EXPONENT = 30;          /* Largest power of two a sweep can reach */
+const long long SWEEP_DEFAULT_CAP_NS = 1000000000LL;  /* Default timeout of a sweep */
+
+/* function declarations */
+bool parse_sweep_range (const char *arg, int& lo, int& hi);
+void expand_sweep_specs (const char *base, int lo, int hi, std::vector<std::string>& specs);
+bool fit_power_law (const std::vector<double>& ns, const std::vector<double>& times,
+    double& exponent, double& constant);
+void detect_cache_sizes (CacheSizes& caches);
+long long read_sysfs_cache_size (int level, bool data);
+const char *cache_level_name (long long bytes, const CacheSizes& caches);
+
+#endif // SWEEP_H
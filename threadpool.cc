@@ -0,0 +1,192 @@
+/**
+ * A small work-stealing thread pool shared by the parallel sorting
+ * algorithms. Every worker owns a deque of tasks: it pushes and pops its
+ * own tasks at the back, and when its deque runs dry it steals from the
+ * front of the others'. Threads outside the pool, such as the main thread,
+ * share one extra deque, and any thread waiting on a group of tasks helps
+ * run queued tasks until the group completes, so fork-join recursion never
+ * blocks a thread outright.
+ */
+
+#include "threadpool.h"
+
+/* Index of the deque owned by the current thread; 0 for external threads */
+static thread_local int worker_index = 0;
+
+/* The pool shared by all parallel algorithms */
+static std::unique_ptr<ThreadPool> shared_pool;
+
+/*
+ * Create a pool in which num_threads threads, counting the external thread
+ * that waits on its tasks, cooperate. A pool of one thread starts no workers
+ * and runs every task inside wait().
+ */
+ThreadPool::ThreadPool (int num_threads) : queued(0), stopping(false)
+{
+    if (num_threads < 1)
+        num_threads = 1;
+
+    for (int i = 0; i < num_threads; ++i)
+        queues.emplace_back(new TaskQueue());
+
+    for (int i = 1; i < num_threads; ++i)
+        workers.emplace_back(&ThreadPool::worker_loop, this, i);
+}
+
+/*
+ * Stop and join all workers. Tasks still queued at this point are dropped.
+ */
+ThreadPool::~ThreadPool ()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (std::size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+/*
+ * Return the number of threads cooperating in the pool.
+ */
+int ThreadPool::num_threads () const
+{
+    return queues.size();
+}
+
+/*
+ * Queue the given task on the current thread's deque as part of the given
+ * group, and wake a sleeping worker to pick it up.
+ */
+void ThreadPool::submit (TaskGroup& group, std::function<void ()> task)
+{
+    TaskQueue& queue = *queues[worker_index];
+
+    group.pending.fetch_add(1);
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{std::move(task), &group});
+    }
+
+    /* Taking the sleep lock orders this increment against a worker that is
+     * about to check the queued count and go to sleep. */
+    queued.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+
+    wake.notify_one();
+}
+
+/*
+ * Run queued tasks on the current thread until every task in the given
+ * group has finished.
+ */
+void ThreadPool::wait (TaskGroup& group)
+{
+    while (group.pending.load() > 0)
+        if (!run_one_task(worker_index))
+            std::this_thread::yield();
+}
+
+/*
+ * Take one task, preferring the newest task on the deque of the given
+ * thread and otherwise stealing the oldest task of another deque, and run
+ * it. Return whether a task was found.
+ */
+bool ThreadPool::run_one_task (int self)
+{
+    const int num_queues = queues.size();
+    Task task;
+    bool found = false;
+
+    {
+        TaskQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    for (int i = 1; i < num_queues && !found; ++i) {
+        TaskQueue& victim = *queues[(self + i) % num_queues];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found)
+        return false;
+
+    queued.fetch_sub(1);
+    task.run();
+    task.group->pending.fetch_sub(1);
+    return true;
+}
+
+/*
+ * Body of each worker thread: run tasks while any are queued, and sleep
+ * until more arrive or the pool is stopped.
+ */
+void ThreadPool::worker_loop (int index)
+{
+    worker_index = index;
+
+    while (!stopping.load()) {
+        if (run_one_task(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+    }
+}
+
+/*
+ * Create the shared pool with the given number of threads, replacing any
+ * pool created earlier.
+ */
+void init_thread_pool (int num_threads)
+{
+    shared_pool.reset();
+    shared_pool.reset(new ThreadPool(num_threads));
+}
+
+/*
+ * Return the shared pool, creating one with a thread per hardware thread if
+ * init_thread_pool() has not been called.
+ */
+ThreadPool& thread_pool ()
+{
+    if (!shared_pool)
+        init_thread_pool(std::thread::hardware_concurrency());
+
+    return *shared_pool;
+}
+
+/*
+ * Run body(begin, end) on the shared pool for consecutive ranges of at most
+ * grain indices covering 0..n - 1, and wait for all of them to finish.
+ */
+void parallel_for (int n, int grain, const std::function<void (int, int)>& body)
+{
+    TaskGroup group;  /* The tasks running each range */
+
+    for (int begin = 0; begin < n; begin += grain) {
+        int end = std::min(n, begin + grain);
+
+        thread_pool().submit(group, [=, &body] { body(begin, end); });
+    }
+
+    thread_pool().wait(group);
+}
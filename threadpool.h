@@ -0,0 +1,70 @@
+/**
+ * A small work-stealing thread pool shared by the parallel sorting
+ * algorithms. Every worker owns a deque of tasks: it pushes and pops its
+ * own tasks at the back, and when its deque runs dry it steals from the
+ * front of the others'. Threads outside the pool, such as the main thread,
+ * share one extra deque, and any thread waiting on a group of tasks helps
+ * run queued tasks until the group completes, so fork-join recursion never
+ * blocks a thread outright.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+/* include statements */
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* A set of tasks that can be waited on together */
+struct TaskGroup {
+    std::atomic<int> pending;  /* Tasks submitted but not yet finished */
+
+    TaskGroup () : pending(0) {}
+};
+
+class ThreadPool {
+public:
+    explicit ThreadPool (int num_threads);
+    ~ThreadPool ();
+
+    int num_threads () const;
+    void submit (TaskGroup& group, std::function<void ()> task);
+    void wait (TaskGroup& group);
+
+private:
+    /* A queued task and the group it counts against */
+    struct Task {
+        std::function<void ()> run;
+        TaskGroup *group;
+    };
+
+    /* One deque of tasks, owned by a worker or by the external threads */
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool run_one_task (int self);
+    void worker_loop (int index);
+
+    std::vector<std::unique_ptr<TaskQueue> > queues;
+    std::vector<std::thread> workers;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<int> queued;
+    std::atomic<bool> stopping;
+};
+
+/* function declarations */
+void init_thread_pool (int num_threads);
+ThreadPool& thread_pool ();
+void parallel_for (int n, int grain, const std::function<void (int, int)>& body);
+
+#endif // THREADPOOL_H
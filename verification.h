@@ -0,0 +1,271 @@
+/**
+ * Verification of the output of every measured cell, so that an algorithm
+ * that fails to sort cannot pass for a fast one. Once per dataset, the
+ * elements are reduced to a fingerprint of their multiset: the sums of two
+ * independent 64-bit hashes of every element, which do not depend on the
+ * order of the elements. After the first timed trial of each cell, outside
+ * the timed region, a single pass over the output recomputes the
+ * fingerprint and checks that no element is smaller than the one before
+ * it. The pass has no branches in its loop, so that it vectorizes, and
+ * costs much less than the sort it checks.
+ *
+ * The output of a top-k algorithm is only checked for the k smallest
+ * elements in order at its front, and that of a selection algorithm for
+ * the k-th smallest at index k - 1 with the rest on the proper sides.
+ *
+ * A cell whose output is out of order, or holds other elements than its
+ * input, such as a record separated from its payload, is reported as
+ * failed, and its times are not counted.
+ *
+ * Records carry the original position of their key, so the same output
+ * also shows whether the algorithm is stable: whether every run of equal
+ * keys is still in the order of their positions. An algorithm that keeps
+ * equal keys in order on every dataset that has any is taken to be stable,
+ * and one that reorders them on any dataset to be unstable.
+ */
+
+#ifndef VERIFICATION_H
+#define VERIFICATION_H
+
+/* include statements */
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "elementtypes.h"
+#include "opcount.h"
+
+/* An order-independent fingerprint of the elements of a dataset */
+struct Fingerprint {
+    std::uint64_t sum;    /* Sum of the first hash of every element */
+    std::uint64_t mixed;  /* Sum of the second hash of every element */
+};
+
+/* What the output of a cell showed about the stability of its algorithm,
+ * ordered so that the combined finding of several cells is the greatest */
+enum Stability {
+    STABILITY_UNTESTED,  /* No equal keys whose positions could be compared */
+    STABILITY_KEPT,      /* Equal keys stayed in the order of their positions */
+    STABILITY_BROKEN     /* Some equal keys were reordered */
+};
+
+/* Whether each element type records its original position, and where */
+template <typename T> struct PositionTraits {
+    static const bool tracked = false;
+
+    static std::int64_t position (const T& x) { (void) x; return 0; }
+};
+
+template <> struct PositionTraits<Record> {
+    static const bool tracked = true;
+
+    static std::int64_t position (const Record& x) { return x.payload; }
+};
+
+template <> struct PositionTraits<WideRecord> {
+    static const bool tracked = true;
+
+    static std::int64_t position (const WideRecord& x) { return x.payload[0]; }
+};
+
+template <typename T> struct PositionTraits<Counted<T> > {
+    static const bool tracked = PositionTraits<T>::tracked;
+
+    static std::int64_t position (const Counted<T>& x)
+    {
+        return PositionTraits<T>::position(x.value);
+    }
+};
+
+/* constants */
+const std::uint64_t FINGERPRINT_SALT = 0x9e3779b97f4a7c15ULL;  /* Seeds the second hash */
+
+/* function declarations */
+template <typename T>
+bool fingerprint_elements (const T *v, int n, Fingerprint& fingerprint);
+inline bool same_fingerprint (const Fingerprint& a, const Fingerprint& b);
+template <typename T>
+bool check_top_k (const T *v, int n, int k);
+template <typename T>
+bool check_selected (const T *v, int n, int k);
+template <typename T>
+Stability check_stability (const T *v, int n);
+inline Stability combine_stability (Stability a, Stability b);
+template <typename T>
+inline std::uint64_t element_bits (const T& x);
+inline std::uint64_t element_bits (const Record& x);
+inline std::uint64_t element_bits (const WideRecord& x);
+template <typename T>
+inline const T& raw_element (const T& x);
+template <typename T>
+inline const T& raw_element (const Counted<T>& x);
+inline std::uint64_t mix_bits (std::uint64_t x);
+
+/*
+ * Compute the fingerprint of the n elements of the given list, and return
+ * whether they are in sorted order.
+ */
+template <typename T>
+bool fingerprint_elements (const T *v, int n, Fingerprint& fingerprint)
+{
+    std::uint64_t sum = 0;    /* Sum of the first hashes so far */
+    std::uint64_t mixed = 0;  /* Sum of the second hashes so far */
+    bool unsorted = false;    /* Whether any element is below the one before it */
+
+    for (int i = 0; i < n; ++i) {
+        const std::uint64_t bits = element_bits(raw_element(v[i]));
+
+        sum += mix_bits(bits);
+        mixed += mix_bits(bits ^ FINGERPRINT_SALT);
+        unsorted |= raw_element(v[i]) < raw_element(v[i > 0 ? i - 1 : 0]);
+    }
+
+    fingerprint = Fingerprint{sum, mixed};
+    return !unsorted;
+}
+
+/*
+ * Return whether the two fingerprints are of the same multiset, barring a
+ * collision of both hashes.
+ */
+inline bool same_fingerprint (const Fingerprint& a, const Fingerprint& b)
+{
+    return a.sum == b.sum && a.mixed == b.mixed;
+}
+
+/*
+ * Return whether the first k of the n elements of the given list are in
+ * sorted order, with none of the others smaller than the last of them.
+ */
+template <typename T>
+bool check_top_k (const T *v, int n, int k)
+{
+    bool misplaced = false;  /* Whether any element is on the wrong side */
+
+    if (k < 1)
+        return true;
+
+    for (int i = 1; i < k; ++i)
+        misplaced |= raw_element(v[i]) < raw_element(v[i - 1]);
+
+    for (int i = k; i < n; ++i)
+        misplaced |= raw_element(v[i]) < raw_element(v[k - 1]);
+
+    return !misplaced;
+}
+
+/*
+ * Return whether the k-th of the n elements of the given list has no
+ * larger element before it and no smaller element after it.
+ */
+template <typename T>
+bool check_selected (const T *v, int n, int k)
+{
+    bool misplaced = false;  /* Whether any element is on the wrong side */
+
+    if (k < 1)
+        return true;
+
+    for (int i = 0; i < k - 1; ++i)
+        misplaced |= raw_element(v[k - 1]) < raw_element(v[i]);
+
+    for (int i = k; i < n; ++i)
+        misplaced |= raw_element(v[i]) < raw_element(v[k - 1]);
+
+    return !misplaced;
+}
+
+/*
+ * Return what the n sorted elements of the given list show about the
+ * stability of the algorithm that sorted them.
+ */
+template <typename T>
+Stability check_stability (const T *v, int n)
+{
+    bool ties = false;    /* Whether any neighbours have equal keys */
+    bool broken = false;  /* Whether any of those are out of position */
+
+    if (!PositionTraits<T>::tracked)
+        return STABILITY_UNTESTED;
+
+    for (int i = 1; i < n; ++i) {
+        const bool tie = !(raw_element(v[i - 1]) < raw_element(v[i]));
+
+        ties |= tie;
+        broken |= tie && PositionTraits<T>::position(v[i]) <
+            PositionTraits<T>::position(v[i - 1]);
+    }
+
+    return broken ? STABILITY_BROKEN : ties ? STABILITY_KEPT : STABILITY_UNTESTED;
+}
+
+/*
+ * Return what two findings about the stability of an algorithm show
+ * together.
+ */
+inline Stability combine_stability (Stability a, Stability b)
+{
+    return std::max(a, b);
+}
+
+/*
+ * Return the bits of the given element, with a record's key and payload
+ * folded together.
+ */
+template <typename T>
+inline std::uint64_t element_bits (const T& x)
+{
+    std::uint64_t bits = 0;  /* Bits of x, zero-extended */
+
+    static_assert(sizeof(T) <= sizeof(bits), "Element too wide for its bits");
+    std::memcpy(&bits, &x, sizeof(T));
+    return bits;
+}
+
+inline std::uint64_t element_bits (const Record& x)
+{
+    return (std::uint64_t) x.key * FINGERPRINT_SALT ^ (std::uint64_t) x.payload;
+}
+
+inline std::uint64_t element_bits (const WideRecord& x)
+{
+    std::uint64_t bits = (std::uint64_t) x.key;  /* Key and payload folded so far */
+
+    for (int w = 0; w < WIDE_PAYLOAD_WORDS; ++w)
+        bits = bits * FINGERPRINT_SALT ^ (std::uint64_t) x.payload[w];
+
+    return bits;
+}
+
+/*
+ * Return the element wrapped by the given element, which is the element
+ * itself unless it is counted. Verifying through it keeps the checks out of
+ * the operation counts.
+ */
+template <typename T>
+inline const T& raw_element (const T& x)
+{
+    return x;
+}
+
+template <typename T>
+inline const T& raw_element (const Counted<T>& x)
+{
+    return x.value;
+}
+
+/*
+ * Return a well mixed 64-bit hash of the given bits, using the finalizer of
+ * SplitMix64.
+ */
+inline std::uint64_t mix_bits (std::uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+#endif // VERIFICATION_H